@@ -30,6 +30,7 @@
 
 #include "kpDefs.h"
 #include "document/kpDocument.h"
+#include "imagelib/kpImageDelta.h"
 #include "generic/kpSetOverrideCursorSaver.h"
 
 #include <KLocalizedString>
@@ -42,6 +43,8 @@ struct kpEffectCommandBasePrivate
     bool actOnSelection{false};
 
     kpImage oldImage;
+    // (used instead of <oldImage> if smaller)
+    kpImageDelta oldImageDelta;
 };
 
 kpEffectCommandBase::kpEffectCommandBase (const QString &name,
@@ -70,7 +73,7 @@ QString kpEffectCommandBase::name () const
 // public virtual [base kpCommand]
 kpCommandSize::SizeType kpEffectCommandBase::size () const
 {
-    return ImageSize (d->oldImage);
+    return ImageSize (d->oldImage) + d->oldImageDelta.size ();
 }
 
 
@@ -93,6 +96,17 @@ void kpEffectCommandBase::execute ()
 
     kpImage newImage = /*pure virtual*/applyEffect (oldImage);
 
+    if (!isInvertible ())
+    {
+        // Many effects only change a few pixels, or change flat areas
+        // uniformly, so storing how to get back from <newImage> is often
+        // much smaller than <oldImage> itself.
+        d->oldImageDelta = kpImageDelta (oldImage, newImage);
+        if (!d->oldImageDelta.isNull ()) {
+            d->oldImage = kpImage ();
+        }
+    }
+
     doc->setImage (d->actOnSelection, newImage);
 }
 
@@ -109,7 +123,12 @@ void kpEffectCommandBase::unexecute ()
 
     if (!isInvertible ())
     {
-        newImage = d->oldImage;
+        if (!d->oldImageDelta.isNull ()) {
+            newImage = d->oldImageDelta.decode (doc->image (d->actOnSelection));
+        }
+        else {
+            newImage = d->oldImage;
+        }
     }
     else
     {
@@ -120,5 +139,12 @@ void kpEffectCommandBase::unexecute ()
 
 
     d->oldImage = kpImage ();
+    d->oldImageDelta = kpImageDelta ();
+}
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpEffectCommandBase::storedImages ()
+{
+    return {&d->oldImage};
 }
 
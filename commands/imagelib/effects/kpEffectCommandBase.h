@@ -51,6 +51,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 public:
     // Return true if applyEffect(applyEffect(image)) == image
     // to avoid storing the old image, saving memory.
@@ -132,6 +132,7 @@ QString kpTransformResizeScaleCommand::name () const
 kpCommandSize::SizeType kpTransformResizeScaleCommand::size () const
 {
     return ImageSize (m_oldImage) +
+           m_oldImageDelta.size () +
            ImageSize (m_oldRightImage) +
            ImageSize (m_oldBottomImage) +
            SelectionSize (m_oldSelectionPtr);
@@ -322,6 +323,21 @@ void kpTransformResizeScaleCommand::execute ()
         kpImage newImage = kpPixmapFX::scale (oldImage, m_newWidth, m_newHeight,
                                                m_type == SmoothScale);
 
+        m_oldImageDelta = kpImageDelta ();
+        if (!m_isLosslessScale && m_type == Scale)
+        {
+            // Scaling the new image back is a good prediction of the old
+            // one: most pixels survive a non-smooth scale and its inverse.
+            // Store only the difference, if that is smaller.
+            const kpImage predictedOldImage =
+                kpPixmapFX::scale (newImage, m_oldWidth, m_oldHeight);
+
+            m_oldImageDelta = kpImageDelta (oldImage, predictedOldImage);
+            if (!m_oldImageDelta.isNull ()) {
+                m_oldImage = kpImage ();
+            }
+        }
+
 
         if (!m_oldSelectionPtr && document ()->selection ())
         {
@@ -443,7 +459,11 @@ void kpTransformResizeScaleCommand::unexecute ()
 
         kpImage oldImage;
 
-        if (!m_isLosslessScale) {
+        if (!m_oldImageDelta.isNull ()) {
+            oldImage = m_oldImageDelta.decode (
+                kpPixmapFX::scale (doc->image (m_actOnSelection),
+                                   m_oldWidth, m_oldHeight));
+        } else if (!m_isLosslessScale) {
             oldImage = m_oldImage;
         } else {
             oldImage = kpPixmapFX::scale (doc->image (m_actOnSelection),
@@ -484,3 +504,9 @@ void kpTransformResizeScaleCommand::unexecute ()
     }
 }
 
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpTransformResizeScaleCommand::storedImages ()
+{
+    return {&m_oldImage, &m_oldRightImage, &m_oldBottomImage};
+}
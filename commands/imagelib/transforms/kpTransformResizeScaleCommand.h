@@ -35,6 +35,7 @@
 #include "imagelib/kpColor.h"
 #include "commands/kpCommand.h"
 #include "imagelib/kpImage.h"
+#include "imagelib/kpImageDelta.h"
 
 
 class QSize;
@@ -82,6 +83,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 protected:
     bool m_actOnSelection;
     int m_newWidth, m_newHeight;
@@ -93,6 +96,8 @@ protected:
     int m_oldWidth, m_oldHeight;
     bool m_actOnTextSelection;
     kpImage m_oldImage, m_oldRightImage, m_oldBottomImage;
+    // (used instead of <m_oldImage> for Scale, if smaller)
+    kpImageDelta m_oldImageDelta;
     kpAbstractSelection *m_oldSelectionPtr;
 };
 
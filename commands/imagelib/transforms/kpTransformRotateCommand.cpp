@@ -218,3 +218,9 @@ void kpTransformRotateCommand::unexecute ()
     QApplication::restoreOverrideCursor ();
 }
 
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpTransformRotateCommand::storedImages ()
+{
+    return {&m_oldImage};
+}
@@ -53,6 +53,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 private:
     bool m_actOnSelection;
     double m_angle;
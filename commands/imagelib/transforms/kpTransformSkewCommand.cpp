@@ -193,3 +193,9 @@ void kpTransformSkewCommand::unexecute ()
     QApplication::restoreOverrideCursor ();
 }
 
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpTransformSkewCommand::storedImages ()
+{
+    return {&m_oldImage};
+}
@@ -52,6 +52,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 private:
     bool m_actOnSelection;
     int m_hangle, m_vangle;
@@ -43,6 +43,13 @@ kpCommand::kpCommand (kpCommandEnvironment *environ)
 kpCommand::~kpCommand () = default;
 
 
+// public virtual
+QList <kpImage *> kpCommand::storedImages ()
+{
+    return {};
+}
+
+
 kpCommandEnvironment *kpCommand::environ () const
 {
     return m_environ;
@@ -30,6 +30,8 @@
 #define kpCommand_H
 
 
+#include <QList>
+
 #include "kpCommandSize.h"
 #undef environ  // macro on win32
 
@@ -70,6 +72,20 @@ public:
     virtual void execute () = 0;
     virtual void unexecute () = 0;
 
+    // Returns pointers to the images that this command keeps only so that
+    // it can execute() or unexecute() itself later (e.g. the old document
+    // image).
+    //
+    // Once the command is deep in the history, kpCommandHistoryBase may
+    // compress these images and set them to null.  It restores them before
+    // calling execute() or unexecute() again.  So implementations must
+    // return the same images in the same order, for as long as neither
+    // method is called, and must not look at their pixels anywhere else.
+    //
+    // The default implementation returns no images, which means that the
+    // command is never compressed.
+    virtual QList <kpImage *> storedImages ();
+
 protected:
     kpCommandEnvironment *environ () const;
 
@@ -31,19 +31,48 @@
 
 #include "kpCommandHistory.h"
 
+#include <QElapsedTimer>
+#include <QRegion>
+
+#include <KSharedConfig>
+#include <KConfigGroup>
+
+#include "kpCommandImageCompressor.h"
+#include "kpCommandTimings.h"
+#include "kpDefs.h"
+#include "kpLogCategories.h"
+#include "document/kpDocument.h"
 #include "layers/selections/kpAbstractSelection.h"
+#include "layers/selections/image/kpAbstractImageSelection.h"
 #include "mainWindow/kpMainWindow.h"
 #include "tools/kpTool.h"
+#include "commands/tools/flow/kpToolFlowCommand.h"
 #include "commands/tools/selection/kpToolSelectionCreateCommand.h"
 
 
 kpCommandHistory::kpCommandHistory (bool doReadConfig, kpMainWindow *mainWindow)
     : kpCommandHistoryBase (doReadConfig, mainWindow->actionCollection ()),
-      m_mainWindow (mainWindow)
+      m_mainWindow (mainWindow),
+      m_coalesceStrokesInterval (0),
+      m_commandTimings (nullptr)
 {
+    if (doReadConfig)
+    {
+        KConfigGroup cfg (KSharedConfig::openConfig (), kpSettingsGroupUndoRedo);
+        setCoalesceStrokesInterval (cfg.readEntry (kpSettingUndoCoalesceStrokesInterval,
+                                                   coalesceStrokesInterval ()));
+
+        const int timingsLimit = cfg.readEntry (kpSettingUndoTimingsLimit, 0);
+        if (timingsLimit > 0) {
+            m_commandTimings = new kpCommandTimings (qMin (timingsLimit, 100000));
+        }
+    }
 }
 
-kpCommandHistory::~kpCommandHistory () = default;
+kpCommandHistory::~kpCommandHistory ()
+{
+    delete m_commandTimings;
+}
 
 
 static bool NextUndoCommandIsCreateBorder (kpCommandHistory *commandHistory)
@@ -90,6 +119,70 @@ void kpCommandHistory::addCreateSelectionCommand (kpToolSelectionCreateCommand *
 
 //---------------------------------------------------------------------
 
+// public
+int kpCommandHistory::coalesceStrokesInterval () const
+{
+    return m_coalesceStrokesInterval;
+}
+
+// public
+void kpCommandHistory::setCoalesceStrokesInterval (int msecs)
+{
+    if (msecs < 0 || msecs > 60 * 1000)
+    {
+        qCCritical(kpLogCommands) << "kpCommandHistory::setCoalesceStrokesInterval("
+                   << msecs << ")";
+        return;
+    }
+
+    m_coalesceStrokesInterval = msecs;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandHistory::addFlowCommand (kpToolFlowCommand *cmd)
+{
+    auto *prevCmd = dynamic_cast <kpToolFlowCommand *> (nextUndoCommand ());
+
+    const bool canCoalesce =
+        m_coalesceStrokesInterval > 0 &&
+        prevCmd &&
+        // (else, undoing the merged command would skip the saved state)
+        m_documentRestoredPosition != 0 &&
+        // (else, the stroke was drawn after an undo and, as usual, must
+        //  start a new command)
+        m_redoCommandList.isEmpty () &&
+        // i.e. same tool
+        prevCmd->name () == cmd->name () &&
+        prevCmd->msecsSinceFinalized () >= 0 &&
+        prevCmd->msecsSinceFinalized () <= m_coalesceStrokesInterval &&
+        prevCmd->boundingRect ().intersects (cmd->boundingRect ());
+
+    if (!canCoalesce)
+    {
+        addCommand (cmd, false/*no exec*/);
+        return;
+    }
+
+#if DEBUG_KP_COMMAND_HISTORY
+    qCDebug(kpLogCommands) << "kpCommandHistory::addFlowCommand() coalescing"
+                           << cmd->boundingRect () << "into" << prevCmd->boundingRect ();
+#endif
+
+    // (the next undo command is never compressed but it may have been
+    //  queued for compression before an undo/redo brought it back)
+    m_imageCompressor->decompress (prevCmd);
+
+    prevCmd->absorb (cmd);
+    delete cmd;
+
+    // The merged command is bigger.
+    trimCommandListsUpdateActions ();
+}
+
+//---------------------------------------------------------------------
+
 // public slot virtual [base KCommandHistory]
 void kpCommandHistory::undo ()
 {
@@ -128,4 +221,102 @@ void kpCommandHistory::redo ()
     }
 }
 
+// protected virtual [base kpCommandHistoryBase]
+QList <kpImage> kpCommandHistory::documentImages () const
+{
+    QList <kpImage> images;
+
+    kpDocument *doc = m_mainWindow ? m_mainWindow->document () : nullptr;
+    if (doc)
+    {
+        images.append (doc->image ());
+
+        if (doc->imageSelection ()) {
+            images.append (doc->imageSelection ()->baseImage ());
+        }
+    }
 
+    return images;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandTimings *kpCommandHistory::commandTimings () const
+{
+    return m_commandTimings;
+}
+
+//---------------------------------------------------------------------
+
+// protected virtual [base kpCommandHistoryBase]
+void kpCommandHistory::executeCommand (kpCommand *command)
+{
+    if (m_commandTimings) {
+        measureCommand (command, false/*execute*/);
+    }
+    else {
+        kpCommandHistoryBase::executeCommand (command);
+    }
+}
+
+// protected virtual [base kpCommandHistoryBase]
+void kpCommandHistory::unexecuteCommand (kpCommand *command)
+{
+    if (m_commandTimings) {
+        measureCommand (command, true/*unexecute*/);
+    }
+    else {
+        kpCommandHistoryBase::unexecuteCommand (command);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpCommandHistory::measureCommand (kpCommand *command, bool isUnexecute)
+{
+    kpDocument *doc = m_mainWindow ? m_mainWindow->document () : nullptr;
+
+    auto memoryUsed = [command, doc] () {
+        return command->size () +
+            (doc ? kpCommandSize::ImageSize (doc->image ()) : 0);
+    };
+
+    QRegion touchedRegion;
+    QMetaObject::Connection connection;
+    if (doc)
+    {
+        connection = connect (doc, &kpDocument::contentsChanged,
+            [&touchedRegion] (const QRect &rect) { touchedRegion += rect; });
+    }
+
+    kpCommandTimings::Record record;
+    record.commandName = command->name ();
+    record.isUnexecute = isUnexecute;
+
+    const kpCommandSize::SizeType memoryBefore = memoryUsed ();
+
+    record.startNsecs = m_commandTimings->nsecsElapsed ();
+    if (isUnexecute) {
+        kpCommandHistoryBase::unexecuteCommand (command);
+    }
+    else {
+        kpCommandHistoryBase::executeCommand (command);
+    }
+    record.durationNsecs = m_commandTimings->nsecsElapsed () - record.startNsecs;
+
+    record.extraMemory = qMax (memoryUsed () - memoryBefore,
+                               static_cast <kpCommandSize::SizeType> (0));
+
+    disconnect (connection);
+
+    for (const QRect &rect : touchedRegion)
+    {
+        record.pixelsTouched += static_cast <qint64> (rect.width ()) * rect.height ();
+    }
+
+    m_commandTimings->addRecord (record);
+}
+
+//---------------------------------------------------------------------
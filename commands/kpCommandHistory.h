@@ -32,7 +32,9 @@
 
 #include "kpCommandHistoryBase.h"
 
+class kpCommandTimings;
 class kpMainWindow;
+class kpToolFlowCommand;
 class kpToolSelectionCreateCommand;
 
 
@@ -93,12 +95,50 @@ public:
     void addCreateSelectionCommand (kpToolSelectionCreateCommand *cmd,
         bool execute = true);
 
+    // Strokes (kpToolFlowCommand's) of the same tool, that overlap the
+    // previous stroke and are finished within this many milliseconds of
+    // it, are merged into one command by addFlowCommand().
+    // 0 (the default) disables this.
+    int coalesceStrokesInterval () const;
+    void setCoalesceStrokesInterval (int msecs);
+
+    // Same as addCommand(<cmd>, false), except that if the next undo
+    // command is a stroke that <cmd> can be coalesced with (see
+    // coalesceStrokesInterval()), <cmd> is merged into it and deleted
+    // instead of being added to the undo history.
+    //
+    // This stops quick, short strokes (e.g. retouching with the pen or
+    // eraser) from filling the history with small commands that each
+    // count towards undoMinLimit() and, where they overlap, hold the same
+    // pixels.  The merged command only stores the tiles touched by either
+    // stroke, from before both of them.
+    void addFlowCommand (kpToolFlowCommand *cmd);
+
+    // Returns the measurements of the commands executed and unexecuted
+    // through this history, or nullptr if the "Timings Limit" undo setting
+    // is 0 (the default).
+    kpCommandTimings *commandTimings () const;
+
 public slots:
     void undo () override;
     void redo () override;
 
 protected:
+    QList <kpImage> documentImages () const override;
+
+    void executeCommand (kpCommand *command) override;
+    void unexecuteCommand (kpCommand *command) override;
+
     kpMainWindow *m_mainWindow;
+
+    int m_coalesceStrokesInterval;
+
+    kpCommandTimings *m_commandTimings;
+
+private:
+    // Calls executeCommand() or unexecuteCommand() of the base class and
+    // adds a record of it to m_commandTimings.
+    void measureCommand (kpCommand *command, bool isUnexecute);
 };
 
 
@@ -44,6 +44,8 @@
 #include <KLocalizedString>
 
 #include "kpCommand.h"
+#include "kpCommandImageCompressor.h"
+#include "kpUndoMemoryManager.h"
 #include "kpLogCategories.h"
 #include "environments/commands/kpCommandEnvironment.h"
 #include "kpDefs.h"
@@ -51,12 +53,14 @@
 #include "mainWindow/kpMainWindow.h"
 #include "tools/kpTool.h"
 
-//---------------------------------------------------------------------
+//--------------------------------------------------------------------------------
 
-static void ClearPointerList(QList<kpCommand *> &list)
+static void AddStoredImages (kpCommand *command, kpSharedImageSizeCounter *counter)
 {
-    qDeleteAll(list);
-    list.clear();
+    for (const kpImage *image : command->storedImages ())
+    {
+        counter->add (*image);
+    }
 }
 
 //--------------------------------------------------------------------------------
@@ -89,11 +93,17 @@ kpCommandHistoryBase::kpCommandHistoryBase (bool doReadConfig,
     m_undoMinLimit = 10;
     m_undoMaxLimit = 500;
     m_undoMaxLimitSizeLimit = 16 * 1048576;
+    m_undoUncompressedLimit = 4;
+    m_sizeBudget = -1;
+
+    m_imageCompressor = new kpCommandImageCompressor (this);
 
 
     m_documentRestoredPosition = 0;
 
 
+    kpUndoMemoryManager::instance ()->registerHistory (this);
+
     if (doReadConfig) {
         readConfig ();
     }
@@ -103,8 +113,10 @@ kpCommandHistoryBase::kpCommandHistoryBase (bool doReadConfig,
 
 kpCommandHistoryBase::~kpCommandHistoryBase ()
 {
-    ::ClearPointerList(m_undoCommandList);
-    ::ClearPointerList(m_redoCommandList);
+    kpUndoMemoryManager::instance ()->unregisterHistory (this);
+
+    clearCommandList (m_undoCommandList);
+    clearCommandList (m_redoCommandList);
 }
 
 //--------------------------------------------------------------------------------
@@ -213,6 +225,112 @@ void kpCommandHistoryBase::setUndoMaxLimitSizeLimit (kpCommandSize::SizeType siz
 }
 
 
+// public
+int kpCommandHistoryBase::undoUncompressedLimit () const
+{
+    return m_undoUncompressedLimit;
+}
+
+// public
+void kpCommandHistoryBase::setUndoUncompressedLimit (int limit)
+{
+#if DEBUG_KP_COMMAND_HISTORY
+    qCDebug(kpLogCommands) << "kpCommandHistoryBase::setUndoUncompressedLimit("
+               << limit << ")";
+#endif
+
+    if (limit < 1 || limit > 5000/*"ought to be enough for anybody"*/)
+    {
+        qCCritical(kpLogCommands) << "kpCommandHistoryBase::setUndoUncompressedLimit("
+                   << limit << ")";
+        return;
+    }
+
+    if (limit == m_undoUncompressedLimit) {
+        return;
+    }
+
+    m_undoUncompressedLimit = limit;
+    trimCommandListsUpdateActions ();
+}
+
+
+// public
+kpCommandSize::SizeType kpCommandHistoryBase::undoSpillSizeLimit () const
+{
+    return m_imageCompressor->spillSizeLimit ();
+}
+
+// public
+void kpCommandHistoryBase::setUndoSpillSizeLimit (kpCommandSize::SizeType sizeLimit)
+{
+#if DEBUG_KP_COMMAND_HISTORY
+    qCDebug(kpLogCommands) << "kpCommandHistoryBase::setUndoSpillSizeLimit("
+               << sizeLimit << ")";
+#endif
+
+    if (sizeLimit < 0 ||
+        sizeLimit > (16 * 1024 * 1048576LL)/*"ought to be enough for anybody"*/)
+    {
+        qCCritical(kpLogCommands) << "kpCommandHistoryBase::setUndoSpillSizeLimit("
+                   << sizeLimit << ")";
+        return;
+    }
+
+    if (sizeLimit == undoSpillSizeLimit ()) {
+        return;
+    }
+
+    m_imageCompressor->setSpillSizeLimit (sizeLimit);
+    trimCommandListsUpdateActions ();
+}
+
+
+// public
+QString kpCommandHistoryBase::undoSpillDirectory () const
+{
+    return m_imageCompressor->spillDirectory ();
+}
+
+// public
+void kpCommandHistoryBase::setUndoSpillDirectory (const QString &directory)
+{
+#if DEBUG_KP_COMMAND_HISTORY
+    qCDebug(kpLogCommands) << "kpCommandHistoryBase::setUndoSpillDirectory("
+               << directory << ")";
+#endif
+
+    m_imageCompressor->setSpillDirectory (directory);
+}
+
+
+// public
+kpCommandSize::SizeType kpCommandHistoryBase::sizeBudget () const
+{
+    return m_sizeBudget;
+}
+
+// public
+void kpCommandHistoryBase::setSizeBudget (kpCommandSize::SizeType budget)
+{
+    if (budget == m_sizeBudget) {
+        return;
+    }
+
+#if DEBUG_KP_COMMAND_HISTORY
+    qCDebug(kpLogCommands) << "kpCommandHistoryBase::setSizeBudget("
+               << budget << ")";
+#endif
+
+    const kpCommandSize::SizeType oldSizeLimit = effectiveSizeLimit ();
+    m_sizeBudget = budget;
+
+    if (effectiveSizeLimit () < oldSizeLimit) {
+        trimCommandListsUpdateActions ();
+    }
+}
+
+
 // public
 void kpCommandHistoryBase::readConfig ()
 {
@@ -226,6 +344,16 @@ void kpCommandHistoryBase::readConfig ()
     setUndoMaxLimitSizeLimit (
         cfg.readEntry <kpCommandSize::SizeType> (kpSettingUndoMaxLimitSizeLimit,
                                                  undoMaxLimitSizeLimit ()));
+    setUndoUncompressedLimit (cfg.readEntry (kpSettingUndoUncompressedLimit,
+                                             undoUncompressedLimit ()));
+    setUndoSpillDirectory (cfg.readEntry (kpSettingUndoSpillDirectory,
+                                          undoSpillDirectory ()));
+    setUndoSpillSizeLimit (
+        cfg.readEntry <kpCommandSize::SizeType> (kpSettingUndoSpillSizeLimit,
+                                                 undoSpillSizeLimit ()));
+    kpUndoMemoryManager::instance ()->setGlobalSizeLimit (
+        cfg.readEntry <kpCommandSize::SizeType> (kpSettingUndoGlobalSizeLimit,
+            kpUndoMemoryManager::instance ()->globalSizeLimit ()));
 
     trimCommandListsUpdateActions ();
 }
@@ -242,6 +370,12 @@ void kpCommandHistoryBase::writeConfig ()
     cfg.writeEntry (kpSettingUndoMaxLimit, undoMaxLimit ());
     cfg.writeEntry <kpCommandSize::SizeType> (
         kpSettingUndoMaxLimitSizeLimit, undoMaxLimitSizeLimit ());
+    cfg.writeEntry (kpSettingUndoUncompressedLimit, undoUncompressedLimit ());
+    cfg.writeEntry (kpSettingUndoSpillDirectory, undoSpillDirectory ());
+    cfg.writeEntry <kpCommandSize::SizeType> (
+        kpSettingUndoSpillSizeLimit, undoSpillSizeLimit ());
+    cfg.writeEntry <kpCommandSize::SizeType> (
+        kpSettingUndoGlobalSizeLimit, kpUndoMemoryManager::instance ()->globalSizeLimit ());
 
     cfg.sync ();
 }
@@ -256,12 +390,14 @@ void kpCommandHistoryBase::addCommand (kpCommand *command, bool execute)
                << ",execute=" << execute << ")"
 #endif
 
+    kpUndoMemoryManager::instance ()->historyUsed (this);
+
     if (execute) {
-        command->execute ();
+        executeCommand (command);
     }
 
     m_undoCommandList.push_front (command);
-    ::ClearPointerList(m_redoCommandList);
+    clearCommandList (m_redoCommandList);
 
 #if DEBUG_KP_COMMAND_HISTORY
     qCDebug(kpLogCommands) << "\tdocumentRestoredPosition=" << m_documentRestoredPosition;
@@ -289,14 +425,32 @@ void kpCommandHistoryBase::clear ()
     qCDebug(kpLogCommands) << "kpCommandHistoryBase::clear()";
 #endif
 
-    ::ClearPointerList(m_undoCommandList);
-    ::ClearPointerList(m_redoCommandList);
+    clearCommandList (m_undoCommandList);
+    clearCommandList (m_redoCommandList);
 
     m_documentRestoredPosition = 0;
 
     updateActions ();
 }
 
+// public
+kpCommandSize::SizeType kpCommandHistoryBase::residentSize () const
+{
+    kpSharedImageSizeCounter counter = documentImagesSizeCounter ();
+    kpCommandSize::SizeType size = 0;
+
+    for (const QList <kpCommand *> *commandList : {&m_undoCommandList, &m_redoCommandList})
+    {
+        for (kpCommand *command : *commandList)
+        {
+            size += commandSize (command, counter);
+            ::AddStoredImages (command, &counter);
+        }
+    }
+
+    return size;
+}
+
 //---------------------------------------------------------------------
 
 // protected slot
@@ -311,7 +465,10 @@ void kpCommandHistoryBase::undoInternal ()
         return;
     }
 
-    undoCommand->unexecute ();
+    kpUndoMemoryManager::instance ()->historyUsed (this);
+
+    m_imageCompressor->decompress (undoCommand);
+    unexecuteCommand (undoCommand);
 
 
     m_undoCommandList.erase (m_undoCommandList.begin ());
@@ -345,7 +502,10 @@ void kpCommandHistoryBase::redoInternal ()
         return;
     }
 
-    redoCommand->execute ();
+    kpUndoMemoryManager::instance ()->historyUsed (this);
+
+    m_imageCompressor->decompress (redoCommand);
+    executeCommand (redoCommand);
 
 
     m_redoCommandList.erase (m_redoCommandList.begin ());
@@ -429,6 +589,19 @@ void kpCommandHistoryBase::redoUpToNumber (QAction *which)
 }
 
 
+// protected virtual
+void kpCommandHistoryBase::executeCommand (kpCommand *command)
+{
+    command->execute ();
+}
+
+// protected virtual
+void kpCommandHistoryBase::unexecuteCommand (kpCommand *command)
+{
+    command->unexecute ();
+}
+
+
 // protected
 QString kpCommandHistoryBase::undoActionText () const
 {
@@ -463,6 +636,65 @@ QString kpCommandHistoryBase::redoActionToolTip () const
 }
 
 
+// protected virtual
+QList <kpImage> kpCommandHistoryBase::documentImages () const
+{
+    return {};
+}
+
+// protected
+kpCommandSize::SizeType kpCommandHistoryBase::effectiveSizeLimit () const
+{
+    if (m_sizeBudget < 0) {
+        return m_undoMaxLimitSizeLimit;
+    }
+
+    return qMin (m_undoMaxLimitSizeLimit, m_sizeBudget);
+}
+
+// protected
+kpSharedImageSizeCounter kpCommandHistoryBase::documentImagesSizeCounter () const
+{
+    kpSharedImageSizeCounter counter;
+
+    for (const kpImage &image : documentImages ())
+    {
+        counter.add (image);
+    }
+
+    return counter;
+}
+
+// protected
+kpCommandSize::SizeType kpCommandHistoryBase::commandSize (kpCommand *command,
+        const kpSharedImageSizeCounter &counter) const
+{
+    kpCommandSize::SizeType size = command->size () + m_imageCompressor->size (command);
+
+    // Replace the estimates for the stored images (which kpCommand::size()
+    // includes) with what they really add.
+    for (const kpImage *image : command->storedImages ())
+    {
+        size -= kpCommandSize::ImageSize (*image);
+        size += counter.extraSize (*image);
+    }
+
+    return qMax (size, static_cast <kpCommandSize::SizeType> (0));
+}
+
+// protected
+void kpCommandHistoryBase::clearCommandList (QList <kpCommand *> &commandList)
+{
+    for (kpCommand *command : qAsConst (commandList))
+    {
+        m_imageCompressor->forget (command);
+        delete command;
+    }
+
+    commandList.clear ();
+}
+
+
 // protected
 void kpCommandHistoryBase::trimCommandListsUpdateActions ()
 {
@@ -471,13 +703,17 @@ void kpCommandHistoryBase::trimCommandListsUpdateActions ()
 #endif
 
     trimCommandLists ();
+    compressCommandLists ();
     updateActions ();
+
+    kpUndoMemoryManager::instance ()->historyChanged (this);
 }
 
 //--------------------------------------------------------------------------------
 
 // protected
-void kpCommandHistoryBase::trimCommandList(QList<kpCommand *> &commandList)
+void kpCommandHistoryBase::trimCommandList(QList<kpCommand *> &commandList,
+        kpSharedImageSizeCounter *counter)
 {
 #if DEBUG_KP_COMMAND_HISTORY
     qCDebug(kpLogCommands) << "kpCommandHistoryBase::trimCommandList()";
@@ -486,13 +722,19 @@ void kpCommandHistoryBase::trimCommandList(QList<kpCommand *> &commandList)
     qCDebug(kpLogCommands) << "\tsize=" << commandList.size()
                << "    undoMinLimit=" << m_undoMinLimit
                << " undoMaxLimit=" << m_undoMaxLimit
-               << " undoMaxLimitSizeLimit=" << m_undoMaxLimitSizeLimit;
+               << " undoMaxLimitSizeLimit=" << m_undoMaxLimitSizeLimit
+               << " sizeBudget=" << m_sizeBudget;
 #endif
+    const kpCommandSize::SizeType sizeLimit = effectiveSizeLimit ();
+
     if ( commandList.size() <= m_undoMinLimit )
     {
     #if DEBUG_KP_COMMAND_HISTORY
         qCDebug(kpLogCommands) << "\t\tsize under undoMinLimit - done";
     #endif
+        for (kpCommand *command : qAsConst (commandList)) {
+            ::AddStoredImages (command, counter);
+        }
         return;
     }
 
@@ -510,33 +752,49 @@ void kpCommandHistoryBase::trimCommandList(QList<kpCommand *> &commandList)
     {
         bool advanceIt = true;
 
-        if (sizeSoFar <= m_undoMaxLimitSizeLimit)
+        if (sizeSoFar <= sizeLimit)
         {
-            sizeSoFar += (*it)->size ();
+            // Rather than deleting a command for not fitting in memory,
+            // try compressing its images now and then moving them to disk.
+            if (upto >= m_undoMinLimit && upto < m_undoMaxLimit &&
+                sizeSoFar + commandSize (*it, *counter) > sizeLimit)
+            {
+                m_imageCompressor->compressImmediately (*it);
+
+                if (sizeSoFar + commandSize (*it, *counter) > sizeLimit) {
+                    m_imageCompressor->spill (*it);
+                }
+            }
+
+            sizeSoFar += commandSize (*it, *counter);
         }
 
     #if DEBUG_KP_COMMAND_HISTORY && 0
         qCDebug(kpLogCommands) << "\t\t" << upto << ":"
                    << " name='" << (*it)->name ()
-                   << "' size=" << (*it)->size ()
+                   << "' size=" << commandSize (*it, *counter)
                    << "    sizeSoFar=" << sizeSoFar;
     #endif
 
         if (upto >= m_undoMinLimit)
         {
             if (upto >= m_undoMaxLimit ||
-                sizeSoFar > m_undoMaxLimitSizeLimit)
+                sizeSoFar > sizeLimit)
             {
             #if DEBUG_KP_COMMAND_HISTORY && 0
                 qCDebug(kpLogCommands) << "\t\t\tkill";
             #endif
+                m_imageCompressor->forget (*it);
                 delete (*it);
-                it = m_undoCommandList.erase (it);
+                it = commandList.erase (it);
                 advanceIt = false;
             }
         }
 
-        if (advanceIt) {
+        if (advanceIt)
+        {
+            // (later commands sharing its images get them for free)
+            ::AddStoredImages (*it, counter);
             it++;
         }
         upto++;
@@ -556,8 +814,12 @@ void kpCommandHistoryBase::trimCommandLists ()
     qCDebug(kpLogCommands) << "kpCommandHistoryBase::trimCommandLists()";
 #endif
 
-    trimCommandList(m_undoCommandList);
-    trimCommandList(m_redoCommandList);
+    // Image buffers shared with the document, or between commands, only
+    // count once.
+    kpSharedImageSizeCounter counter = documentImagesSizeCounter ();
+
+    trimCommandList(m_undoCommandList, &counter);
+    trimCommandList(m_redoCommandList, &counter);
 
 #if DEBUG_KP_COMMAND_HISTORY
     qCDebug(kpLogCommands) << "\tdocumentRestoredPosition=" << m_documentRestoredPosition
@@ -579,6 +841,30 @@ void kpCommandHistoryBase::trimCommandLists ()
     }
 }
 
+//--------------------------------------------------------------------------------
+
+// protected
+void kpCommandHistoryBase::compressCommandList (const QList <kpCommand *> &commandList)
+{
+    for (int i = m_undoUncompressedLimit; i < commandList.size (); i++)
+    {
+        m_imageCompressor->compress (commandList [i]);
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+// protected
+void kpCommandHistoryBase::compressCommandLists ()
+{
+#if DEBUG_KP_COMMAND_HISTORY
+    qCDebug(kpLogCommands) << "kpCommandHistoryBase::compressCommandLists()";
+#endif
+
+    compressCommandList (m_undoCommandList);
+    compressCommandList (m_redoCommandList);
+}
+
 
 static void populatePopupMenu (QMenu *popupMenu,
                                const QString &undoOrRedo,
@@ -694,6 +980,7 @@ void kpCommandHistoryBase::setNextUndoCommand (kpCommand *command)
         return;
     }
 
+    m_imageCompressor->forget (*m_undoCommandList.begin ());
     delete *m_undoCommandList.begin ();
     *m_undoCommandList.begin () = command;
 
@@ -43,12 +43,18 @@ class KActionCollection;
 class KToolBarPopupAction;
 
 class kpCommand;
+class kpCommandImageCompressor;
 
 
 // Clone of KCommandHistory with features required by KolourPaint but which
 // could also be useful for other apps:
 // - nextUndoCommand()/nextRedoCommand()
 // - undo/redo history limited by both number and size
+// - images stored by older commands are compressed (see
+//   kpCommand::storedImages()) and, optionally, spilled to disk instead of
+//   being deleted when over the size limit
+// - the memory used by all histories in the process can be capped as well
+//   (see kpUndoMemoryManager)
 //
 // Features not required by KolourPaint (e.g. commandExecuted()) are not
 // implemented and undo limit == redo limit.  So compared to
@@ -76,6 +82,30 @@ public:
     kpCommandSize::SizeType undoMaxLimitSizeLimit () const;
     void setUndoMaxLimitSizeLimit (kpCommandSize::SizeType sizeLimit);
 
+    // The number of most recent undo (and redo) commands whose images are
+    // kept uncompressed, for instant undo/redo.  The images of all older
+    // commands are compressed in the background.
+    int undoUncompressedLimit () const;
+    void setUndoUncompressedLimit (int limit);
+
+    // How much of the images of old commands, that don't fit under
+    // undoMaxLimitSizeLimit(), may be moved to a temporary file in
+    // undoSpillDirectory() instead of deleting those commands.
+    // 0 (the default) disables this.
+    kpCommandSize::SizeType undoSpillSizeLimit () const;
+    void setUndoSpillSizeLimit (kpCommandSize::SizeType sizeLimit);
+
+    // (empty for the system's temporary directory)
+    QString undoSpillDirectory () const;
+    void setUndoSpillDirectory (const QString &directory);
+
+    // (interface for kpUndoMemoryManager)
+    //
+    // Further limits the memory used by this history, as its share of
+    // kpUndoMemoryManager::globalSizeLimit().  -1 means no further limit.
+    kpCommandSize::SizeType sizeBudget () const;
+    void setSizeBudget (kpCommandSize::SizeType budget);
+
 public:
     // Read and write above config
     void readConfig ();
@@ -85,6 +115,13 @@ public:
     void addCommand (kpCommand *command, bool execute = true);
     void clear ();
 
+    // Returns the memory really used by the undo and redo commands:
+    // image buffers that are shared between commands are counted once and
+    // those shared with documentImages() are not counted at all.
+    //
+    // This is what is compared against undoMaxLimitSizeLimit().
+    kpCommandSize::SizeType residentSize () const;
+
 protected slots:
     // (same as undo() & redo() except they don't call
     //  trimCommandListsUpdateActions())
@@ -98,6 +135,12 @@ public slots:
     virtual void undoUpToNumber (QAction *which);
     virtual void redoUpToNumber (QAction *which);
 
+protected:
+    // Calls <command>'s execute() or unexecute().  All calls made by this
+    // class go through these, so that they can be measured.
+    virtual void executeCommand (kpCommand *command);
+    virtual void unexecuteCommand (kpCommand *command);
+
 protected:
     QString undoActionText () const;
     QString redoActionText () const;
@@ -105,9 +148,31 @@ protected:
     QString undoActionToolTip () const;
     QString redoActionToolTip () const;
 
+    // Returns the images that are in memory regardless of the history
+    // (e.g. the document image), for residentSize().
+    //
+    // The default implementation returns no images.
+    virtual QList <kpImage> documentImages () const;
+
+    // Returns the lower of undoMaxLimitSizeLimit() and sizeBudget().
+    kpCommandSize::SizeType effectiveSizeLimit () const;
+
+    // Returns a counter that has already seen documentImages().
+    kpSharedImageSizeCounter documentImagesSizeCounter () const;
+
+    // Returns the memory used by <command>, including its compressed images,
+    // except for stored images whose buffers <counter> has already seen.
+    kpCommandSize::SizeType commandSize (kpCommand *command,
+        const kpSharedImageSizeCounter &counter) const;
+
+    void clearCommandList (QList <kpCommand *> &commandList);
+
     void trimCommandListsUpdateActions ();
-    void trimCommandList(QList<kpCommand *> &commandList);
+    void trimCommandList(QList<kpCommand *> &commandList,
+        kpSharedImageSizeCounter *counter);
     void trimCommandLists ();
+    void compressCommandList (const QList <kpCommand *> &commandList);
+    void compressCommandLists ();
     void updateActions ();
 
 public:
@@ -131,6 +196,10 @@ protected:
 
     int m_undoMinLimit, m_undoMaxLimit;
     kpCommandSize::SizeType m_undoMaxLimitSizeLimit;
+    int m_undoUncompressedLimit;
+    kpCommandSize::SizeType m_sizeBudget;
+
+    kpCommandImageCompressor *m_imageCompressor;
 
     // What you have to do to get back to the document's unmodified state:
     // * -x: must Undo x times
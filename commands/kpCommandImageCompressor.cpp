@@ -0,0 +1,588 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#define DEBUG_KP_COMMAND_IMAGE_COMPRESSOR 0
+
+
+#include "kpCommandImageCompressor.h"
+
+#include <cstring>
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QDir>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QTemporaryFile>
+#include <QThreadPool>
+#include <QVector>
+
+#include "kpLogCategories.h"
+
+#include "commands/kpCommand.h"
+#include "imagelib/kpImage.h"
+
+//---------------------------------------------------------------------
+
+struct kpCompressedImage
+{
+    // (null for a null image)
+    QByteArray data;
+
+    int width{0}, height{0};
+    QImage::Format format{QImage::Format_Invalid};
+    QVector <QRgb> colorTable;
+    int dotsPerMeterX{0}, dotsPerMeterY{0};
+    QPoint offset;
+};
+
+//---------------------------------------------------------------------
+
+static kpCompressedImage CompressImage (const kpImage &image)
+{
+    kpCompressedImage ret;
+
+    if (image.isNull ()) {
+        return ret;
+    }
+
+    // zlib's fastest level: most of what we store is flat color or
+    // repeating patterns, which even level 1 handles well.
+    ret.data = qCompress (image.constBits (),
+                          static_cast <int> (image.sizeInBytes ()),
+                          1/*compression level*/);
+
+    ret.width = image.width ();
+    ret.height = image.height ();
+    ret.format = image.format ();
+    ret.colorTable = image.colorTable ();
+    ret.dotsPerMeterX = image.dotsPerMeterX ();
+    ret.dotsPerMeterY = image.dotsPerMeterY ();
+    ret.offset = image.offset ();
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+static kpImage DecompressImage (const kpCompressedImage &compressed)
+{
+    if (compressed.data.isNull ()) {
+        return {};
+    }
+
+    kpImage image (compressed.width, compressed.height, compressed.format);
+
+    const QByteArray bytes = qUncompress (compressed.data);
+    if (image.isNull () || bytes.size () != image.sizeInBytes ())
+    {
+        qCCritical(kpLogCommands) << "kpCommandImageCompressor: could not decompress"
+                                  << compressed.width << "x" << compressed.height
+                                  << "image";
+        return {};
+    }
+
+    std::memcpy (image.bits (), bytes.constData (), static_cast <size_t> (bytes.size ()));
+
+    image.setColorTable (compressed.colorTable);
+    image.setDotsPerMeterX (compressed.dotsPerMeterX);
+    image.setDotsPerMeterY (compressed.dotsPerMeterY);
+    image.setOffset (compressed.offset);
+
+    return image;
+}
+
+//---------------------------------------------------------------------
+
+struct kpCommandImageCompressorJob
+{
+    kpCommand *command{nullptr};
+
+    // Set by the GUI thread to ask the worker thread to stop early.
+    QAtomicInt cancelled;
+
+    // Guards <owner>, which the worker thread needs to report back.
+    QMutex ownerMutex;
+    kpCommandImageCompressor *owner{nullptr};
+
+    // The images to compress.  These are shallow copies so they stay
+    // readable even if the command detaches its own copies.
+    // (cleared once the command's images have been taken away)
+    QList <kpImage> images;
+
+    // Written by the worker thread; only read by the GUI thread after
+    // jobFinished().
+    QList <kpCompressedImage> compressedImages;
+
+    // (GUI thread only)
+    bool isCompressed{false};
+    kpCommandSize::SizeType compressedSize{0};
+
+    // If the compressed images have been spilled, the mapping of the spill
+    // file that their data now points into.
+    uchar *spillMap{nullptr};
+};
+
+//---------------------------------------------------------------------
+
+class kpCommandImageCompressorRunnable : public QRunnable
+{
+public:
+    kpCommandImageCompressorRunnable (
+            const QSharedPointer <kpCommandImageCompressorJob> &job)
+        : m_job (job)
+    {
+    }
+
+    void run () override
+    {
+        QList <kpCompressedImage> compressedImages;
+
+        for (const auto &image : qAsConst (m_job->images))
+        {
+            if (m_job->cancelled.loadAcquire ()) {
+                return;
+            }
+
+            compressedImages.append (::CompressImage (image));
+        }
+
+        m_job->compressedImages = compressedImages;
+
+        QMutexLocker ownerLocker (&m_job->ownerMutex);
+        if (m_job->owner)
+        {
+            kpCommandImageCompressor *owner = m_job->owner;
+            QSharedPointer <kpCommandImageCompressorJob> job = m_job;
+
+            // (if <owner> is deleted before this is delivered, it is dropped)
+            QMetaObject::invokeMethod (owner,
+                [owner, job] () { owner->jobFinished (job); },
+                Qt::QueuedConnection);
+        }
+    }
+
+private:
+    QSharedPointer <kpCommandImageCompressorJob> m_job;
+};
+
+//---------------------------------------------------------------------
+
+// Stops <job> from touching its images any further or reporting back.
+static void CancelJob (kpCommandImageCompressorJob *job)
+{
+    job->cancelled.storeRelease (1);
+
+    QMutexLocker ownerLocker (&job->ownerMutex);
+    job->owner = nullptr;
+}
+
+//---------------------------------------------------------------------
+
+kpCommandImageCompressor::kpCommandImageCompressor (QObject *parent)
+    : QObject (parent),
+      m_spillSizeLimit (0),
+      m_spillFile (nullptr),
+      m_spillFileSize (0),
+      m_spilledCount (0)
+{
+}
+
+//---------------------------------------------------------------------
+
+kpCommandImageCompressor::~kpCommandImageCompressor ()
+{
+    clear ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpCommandImageCompressor::isCompressed (kpCommand *command) const
+{
+    return m_jobs.contains (command);
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandImageCompressor::compress (kpCommand *command)
+{
+    if (m_jobs.contains (command)) {
+        return;
+    }
+
+    QSharedPointer <kpCommandImageCompressorJob> job (new kpCommandImageCompressorJob ());
+    job->command = command;
+    job->owner = this;
+
+    foreach (kpImage *image, command->storedImages ())
+    {
+        job->images.append (*image);
+    }
+
+    m_jobs.insert (command, job);
+
+    // Commands that don't store any images are remembered as compressed,
+    // so that we don't keep asking them.
+    if (job->images.isEmpty ())
+    {
+        job->isCompressed = true;
+        return;
+    }
+
+#if DEBUG_KP_COMMAND_IMAGE_COMPRESSOR
+    qCDebug(kpLogCommands) << "kpCommandImageCompressor::compress(" << command->name ()
+                           << ") images=" << job->images.size ();
+#endif
+
+    QThreadPool::globalInstance ()->start (new kpCommandImageCompressorRunnable (job));
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandImageCompressor::compressImmediately (kpCommand *command)
+{
+    QSharedPointer <kpCommandImageCompressorJob> job = m_jobs.value (command);
+    if (job && job->isCompressed) {
+        return;
+    }
+
+    // (cancels any background compression)
+    forget (command);
+    compressNow (command);
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpCommandImageCompressor::jobFinished (
+        const QSharedPointer <kpCommandImageCompressorJob> &job)
+{
+    if (job->cancelled.loadAcquire () || m_jobs.value (job->command) != job) {
+        return;
+    }
+
+    const QList <kpImage *> images = job->command->storedImages ();
+
+    // The command must not have changed its images since compress() -
+    // if it has, keep them and forget what we compressed.
+    bool unchanged = (images.size () == job->images.size ());
+    for (int i = 0; unchanged && i < images.size (); i++)
+    {
+        unchanged = (images [i]->cacheKey () == job->images [i].cacheKey ());
+    }
+
+    if (!unchanged)
+    {
+        qCWarning(kpLogCommands) << "kpCommandImageCompressor: images of command"
+                                 << job->command->name () << "changed while compressing";
+        job->compressedImages.clear ();
+        job->images.clear ();
+        job->isCompressed = true;
+        return;
+    }
+
+    kpCommandSize::SizeType compressedSize = 0;
+    for (const auto &compressed : qAsConst (job->compressedImages))
+    {
+        compressedSize += compressed.data.size ();
+    }
+
+    for (kpImage *image : images)
+    {
+        *image = kpImage ();
+    }
+
+    job->images.clear ();
+    job->isCompressed = true;
+    job->compressedSize = compressedSize;
+
+#if DEBUG_KP_COMMAND_IMAGE_COMPRESSOR
+    qCDebug(kpLogCommands) << "kpCommandImageCompressor::jobFinished(" << job->command->name ()
+                           << ") compressedSize=" << compressedSize;
+#endif
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandImageCompressor::decompress (kpCommand *command)
+{
+    QSharedPointer <kpCommandImageCompressorJob> job = m_jobs.take (command);
+    if (!job) {
+        return;
+    }
+
+    ::CancelJob (job.data ());
+
+    if (!job->isCompressed || job->compressedImages.isEmpty ()) {
+        return;
+    }
+
+    const QList <kpImage *> images = command->storedImages ();
+    Q_ASSERT (images.size () == job->compressedImages.size ());
+
+    for (int i = 0; i < images.size () && i < job->compressedImages.size (); i++)
+    {
+        *images [i] = ::DecompressImage (job->compressedImages [i]);
+    }
+
+    releaseSpill (job.data ());
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandImageCompressor::forget (kpCommand *command)
+{
+    QSharedPointer <kpCommandImageCompressorJob> job = m_jobs.take (command);
+    if (!job) {
+        return;
+    }
+
+    ::CancelJob (job.data ());
+    releaseSpill (job.data ());
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandImageCompressor::clear ()
+{
+    const QList <kpCommand *> commands = m_jobs.keys ();
+    for (kpCommand *command : commands)
+    {
+        forget (command);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpCommandImageCompressor::size (kpCommand *command) const
+{
+    QSharedPointer <kpCommandImageCompressorJob> job = m_jobs.value (command);
+    return job ? job->compressedSize : 0;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QString kpCommandImageCompressor::spillDirectory () const
+{
+    return m_spillDirectory;
+}
+
+// public
+void kpCommandImageCompressor::setSpillDirectory (const QString &directory)
+{
+    m_spillDirectory = directory;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpCommandImageCompressor::spillSizeLimit () const
+{
+    return m_spillSizeLimit;
+}
+
+// public
+void kpCommandImageCompressor::setSpillSizeLimit (kpCommandSize::SizeType sizeLimit)
+{
+    m_spillSizeLimit = sizeLimit;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpCommandImageCompressor::isSpilled (kpCommand *command) const
+{
+    QSharedPointer <kpCommandImageCompressorJob> job = m_jobs.value (command);
+    return job && job->spillMap;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpCommandImageCompressor::spill (kpCommand *command)
+{
+    if (m_spillSizeLimit <= 0) {
+        return false;
+    }
+
+    QSharedPointer <kpCommandImageCompressorJob> job = m_jobs.value (command);
+    if (job && job->spillMap) {
+        return true;
+    }
+
+    if (!job || !job->isCompressed)
+    {
+        // (cancels any background compression)
+        forget (command);
+        job = compressNow (command);
+    }
+
+    qint64 totalSize = 0;
+    for (const auto &compressed : qAsConst (job->compressedImages))
+    {
+        totalSize += compressed.data.size ();
+    }
+
+    if (totalSize == 0 || m_spillFileSize + totalSize > m_spillSizeLimit) {
+        return false;
+    }
+
+    if (!openSpillFile ()) {
+        return false;
+    }
+
+    bool ok = m_spillFile->seek (m_spillFileSize);
+    for (int i = 0; ok && i < job->compressedImages.size (); i++)
+    {
+        const QByteArray &data = job->compressedImages [i].data;
+        ok = (m_spillFile->write (data) == data.size ());
+    }
+    ok = ok && m_spillFile->flush ();
+
+    uchar *map = ok ? m_spillFile->map (m_spillFileSize, totalSize) : nullptr;
+    if (!map)
+    {
+        qCWarning(kpLogCommands) << "kpCommandImageCompressor: could not spill to"
+                                 << m_spillFile->fileName () << ":"
+                                 << m_spillFile->errorString ();
+        m_spillFile->resize (m_spillFileSize);
+        return false;
+    }
+
+    // Point the compressed images into the mapping, freeing their memory.
+    qint64 offset = 0;
+    for (auto &compressed : job->compressedImages)
+    {
+        const int dataSize = compressed.data.size ();
+        compressed.data = QByteArray::fromRawData (
+            reinterpret_cast <const char *> (map + offset), dataSize);
+        offset += dataSize;
+    }
+
+    job->spillMap = map;
+    job->compressedSize = 0;
+
+    m_spillFileSize += totalSize;
+    m_spilledCount++;
+
+#if DEBUG_KP_COMMAND_IMAGE_COMPRESSOR
+    qCDebug(kpLogCommands) << "kpCommandImageCompressor::spill(" << command->name ()
+                           << ") size=" << totalSize
+                           << " spillFileSize=" << m_spillFileSize;
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// private
+QSharedPointer <kpCommandImageCompressorJob> kpCommandImageCompressor::compressNow (
+        kpCommand *command)
+{
+    QSharedPointer <kpCommandImageCompressorJob> job (new kpCommandImageCompressorJob ());
+    job->command = command;
+
+    foreach (kpImage *image, command->storedImages ())
+    {
+        job->compressedImages.append (::CompressImage (*image));
+        job->compressedSize += job->compressedImages.last ().data.size ();
+
+        *image = kpImage ();
+    }
+
+    job->isCompressed = true;
+
+    m_jobs.insert (command, job);
+
+    return job;
+}
+
+//---------------------------------------------------------------------
+
+// private
+bool kpCommandImageCompressor::openSpillFile ()
+{
+    if (m_spillFile) {
+        return true;
+    }
+
+    const QString directory = m_spillDirectory.isEmpty () ?
+        QDir::tempPath () : m_spillDirectory;
+
+    m_spillFile = new QTemporaryFile (
+        QDir (directory).filePath (QStringLiteral ("kolourpaint-undo-XXXXXX")),
+        this);
+    if (!m_spillFile->open ())
+    {
+        qCWarning(kpLogCommands) << "kpCommandImageCompressor: could not create spill file in"
+                                 << directory << ":" << m_spillFile->errorString ();
+        delete m_spillFile;
+        m_spillFile = nullptr;
+        return false;
+    }
+
+    m_spillFileSize = 0;
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpCommandImageCompressor::releaseSpill (kpCommandImageCompressorJob *job)
+{
+    if (!job->spillMap) {
+        return;
+    }
+
+    // (the data would be dangling)
+    job->compressedImages.clear ();
+
+    m_spillFile->unmap (job->spillMap);
+    job->spillMap = nullptr;
+
+    // Space in the middle of the file is not reused but once nothing is
+    // spilled, the whole file goes.
+    if (--m_spilledCount == 0)
+    {
+        delete m_spillFile;
+        m_spillFile = nullptr;
+        m_spillFileSize = 0;
+    }
+}
+
+//---------------------------------------------------------------------
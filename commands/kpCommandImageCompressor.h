@@ -0,0 +1,142 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef kpCommandImageCompressor_H
+#define kpCommandImageCompressor_H
+
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+
+#include "commands/kpCommandSize.h"
+
+
+class QTemporaryFile;
+
+class kpCommand;
+
+struct kpCommandImageCompressorJob;
+
+
+//
+// Compresses the kpCommand::storedImages() of commands that are deep in the
+// command history, so that more of them fit under the history's size limit.
+//
+// Compression is lossless (zlib at its fastest level) and happens on a
+// worker thread.  When it finishes, back in the GUI thread, the command's
+// images are set to null and the compressed copies are kept here instead.
+// decompress() undoes this and must be called before the command is
+// executed or unexecuted again.
+//
+// Optionally, compressed images can also be spilled to a memory-mapped
+// temporary file, for commands that would otherwise have to be deleted
+// to stay under the history's memory limit.  They are paged back in by
+// decompress().
+//
+class kpCommandImageCompressor : public QObject
+{
+Q_OBJECT
+
+public:
+    kpCommandImageCompressor (QObject *parent = nullptr);
+    ~kpCommandImageCompressor () override;
+
+
+    // Returns whether compress() has been called for <command>, without a
+    // later decompress() or forget().
+    bool isCompressed (kpCommand *command) const;
+
+    // Starts compressing the images of <command> in the background.
+    void compress (kpCommand *command);
+
+    // Same as compress() but, unless that has already finished, compresses
+    // in this thread, so that the memory is freed on return.
+    void compressImmediately (kpCommand *command);
+
+    // Gives <command> its images back.  If compression has not finished
+    // yet, it is cancelled and the command is left alone.
+    void decompress (kpCommand *command);
+
+    // Drops any compressed data for <command>, which is about to be deleted.
+    void forget (kpCommand *command);
+
+    // forget()s all commands.
+    void clear ();
+
+
+    // Returns the size of the compressed images held in memory for
+    // <command>.  This is 0 until the images have been taken away from the
+    // command, and after they have been spilled.  i.e. this should be added
+    // to kpCommand::size().
+    kpCommandSize::SizeType size (kpCommand *command) const;
+
+
+    // The spill file is created in <directory> (the system's temporary
+    // directory if empty).  A change only takes effect once nothing is
+    // spilled anymore, at which point the file is deleted.
+    QString spillDirectory () const;
+    void setSpillDirectory (const QString &directory);
+
+    // The maximum size of the spill file.  0 disables spilling.
+    kpCommandSize::SizeType spillSizeLimit () const;
+    void setSpillSizeLimit (kpCommandSize::SizeType sizeLimit);
+
+    bool isSpilled (kpCommand *command) const;
+
+    // Moves the compressed images of <command> into the spill file,
+    // compressing them first (in this thread) if that hasn't finished yet.
+    //
+    // Returns false if spilling is disabled, if <command> doesn't store any
+    // images or if they don't fit in the spill file.  In that case, the
+    // caller is expected to delete <command>.
+    bool spill (kpCommand *command);
+
+private:
+    void jobFinished (const QSharedPointer <kpCommandImageCompressorJob> &job);
+
+    QSharedPointer <kpCommandImageCompressorJob> compressNow (kpCommand *command);
+
+    bool openSpillFile ();
+    void releaseSpill (kpCommandImageCompressorJob *job);
+
+    QHash <kpCommand *, QSharedPointer <kpCommandImageCompressorJob> > m_jobs;
+
+    QString m_spillDirectory;
+    kpCommandSize::SizeType m_spillSizeLimit;
+
+    QTemporaryFile *m_spillFile;
+    qint64 m_spillFileSize;
+    int m_spilledCount;
+
+    friend class kpCommandImageCompressorRunnable;
+};
+
+
+#endif  // kpCommandImageCompressor_H
@@ -150,3 +150,35 @@ kpCommandSize::SizeType kpCommandSize::PolygonSize (const QPolygon &points)
     return static_cast<SizeType> (static_cast<unsigned int> (points.size ()) * sizeof (QPoint));
 }
 
+//---------------------------------------------------------------------
+
+kpSharedImageSizeCounter::kpSharedImageSizeCounter ()
+    : m_total (0)
+{
+}
+
+// public
+kpCommandSize::SizeType kpSharedImageSizeCounter::extraSize (const QImage &image) const
+{
+    if (image.isNull () || m_cacheKeys.contains (image.cacheKey ())) {
+        return 0;
+    }
+
+    return static_cast <kpCommandSize::SizeType> (image.sizeInBytes ());
+}
+
+// public
+void kpSharedImageSizeCounter::add (const QImage &image)
+{
+    m_total += extraSize (image);
+
+    if (!image.isNull ()) {
+        m_cacheKeys.insert (image.cacheKey ());
+    }
+}
+
+// public
+kpCommandSize::SizeType kpSharedImageSizeCounter::total () const
+{
+    return m_total;
+}
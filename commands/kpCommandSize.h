@@ -30,6 +30,8 @@
 #define kpCommandSize_H
 
 
+#include <QSet>
+
 #include "imagelib/kpImage.h"
 
 
@@ -84,4 +86,32 @@ public:
 };
 
 
+//
+// Measures the memory really used by a set of images.
+//
+// Unlike kpCommandSize::ImageSize(), an implicitly shared image buffer
+// (e.g. an image stored by several commands, or by a command and the
+// document) is only counted the first time it is seen, and its actual
+// allocation (including scanline padding) is counted.
+//
+class kpSharedImageSizeCounter
+{
+public:
+    kpSharedImageSizeCounter ();
+
+    // Returns how much add()ing <image> would increase total() by i.e.
+    // 0 if an image sharing its buffer has already been added.
+    kpCommandSize::SizeType extraSize (const QImage &image) const;
+
+    void add (const QImage &image);
+
+    kpCommandSize::SizeType total () const;
+
+private:
+    // (QImage::cacheKey() is the same for all images sharing a buffer)
+    QSet <qint64> m_cacheKeys;
+    kpCommandSize::SizeType m_total;
+};
+
+
 #endif  // kpCommandSize_H
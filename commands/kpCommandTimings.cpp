@@ -0,0 +1,135 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "kpCommandTimings.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+//---------------------------------------------------------------------
+
+kpCommandTimings::kpCommandTimings (int capacity)
+    : m_capacity (qMax (capacity, 1)),
+      m_next (0)
+{
+    m_timer.start ();
+    m_records.reserve (m_capacity);
+}
+
+//---------------------------------------------------------------------
+
+// public
+int kpCommandTimings::capacity () const
+{
+    return m_capacity;
+}
+
+//---------------------------------------------------------------------
+
+// public
+qint64 kpCommandTimings::nsecsElapsed () const
+{
+    return m_timer.nsecsElapsed ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandTimings::addRecord (const Record &record)
+{
+    if (m_records.size () < m_capacity)
+    {
+        m_records.append (record);
+        return;
+    }
+
+    m_records [m_next] = record;
+    m_next = (m_next + 1) % m_capacity;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QVector <kpCommandTimings::Record> kpCommandTimings::records () const
+{
+    if (m_records.size () < m_capacity) {
+        return m_records;
+    }
+
+    return m_records.mid (m_next) + m_records.mid (0, m_next);
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpCommandTimings::clear ()
+{
+    m_records.clear ();
+    m_next = 0;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QByteArray kpCommandTimings::toChromeTrace () const
+{
+    const qint64 pid = QCoreApplication::applicationPid ();
+
+    QJsonArray events;
+
+    for (const Record &record : records ())
+    {
+        QJsonObject args;
+        args [QStringLiteral ("extraMemory")] = record.extraMemory;
+        args [QStringLiteral ("pixelsTouched")] = record.pixelsTouched;
+
+        // "Complete" events, in microseconds.
+        QJsonObject event;
+        event [QStringLiteral ("name")] = record.commandName;
+        event [QStringLiteral ("cat")] = record.isUnexecute ?
+            QStringLiteral ("unexecute") : QStringLiteral ("execute");
+        event [QStringLiteral ("ph")] = QStringLiteral ("X");
+        event [QStringLiteral ("ts")] = record.startNsecs / 1000.0;
+        event [QStringLiteral ("dur")] = record.durationNsecs / 1000.0;
+        event [QStringLiteral ("pid")] = pid;
+        event [QStringLiteral ("tid")] = 0;
+        event [QStringLiteral ("args")] = args;
+
+        events.append (event);
+    }
+
+    QJsonObject trace;
+    trace [QStringLiteral ("traceEvents")] = events;
+    trace [QStringLiteral ("displayTimeUnit")] = QStringLiteral ("ms");
+
+    return QJsonDocument (trace).toJson (QJsonDocument::Compact);
+}
+
+//---------------------------------------------------------------------
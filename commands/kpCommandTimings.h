@@ -0,0 +1,100 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef kpCommandTimings_H
+#define kpCommandTimings_H
+
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+#include "commands/kpCommandSize.h"
+
+
+//
+// Keeps measurements of the most recent kpCommand::execute() and
+// kpCommand::unexecute() calls made by kpCommandHistory, so that slow
+// operations can be found.
+//
+// Only the last capacity() records are kept (in a ring buffer).  Recording
+// is off unless the "Timings Limit" undo setting is non-zero, in which case
+// kpCommandHistory creates one of these; otherwise, it costs a pointer
+// check per command.
+//
+class kpCommandTimings
+{
+public:
+    struct Record
+    {
+        QString commandName;
+        bool isUnexecute{false};
+
+        // Since the kpCommandTimings was created.
+        qint64 startNsecs{0};
+        qint64 durationNsecs{0};
+
+        // How much more memory the command and the document use afterwards.
+        kpCommandSize::SizeType extraMemory{0};
+
+        // The number of document pixels that were changed (or, at least,
+        // reported as changed).
+        qint64 pixelsTouched{0};
+    };
+
+    kpCommandTimings (int capacity);
+
+    int capacity () const;
+
+    // Returns the nanoseconds since this was created, for
+    // Record::startNsecs.
+    qint64 nsecsElapsed () const;
+
+    void addRecord (const Record &record);
+
+    // Returns the kept records, oldest first.
+    QVector <Record> records () const;
+
+    void clear ();
+
+    // Returns records() in the Chrome trace event format (JSON), as
+    // understood by chrome://tracing and Perfetto.
+    QByteArray toChromeTrace () const;
+
+private:
+    QElapsedTimer m_timer;
+
+    QVector <Record> m_records;
+    int m_capacity;
+    // Where the next record goes, once m_records is full.
+    int m_next;
+};
+
+
+#endif  // kpCommandTimings_H
@@ -124,6 +124,21 @@ void kpMacroCommand::unexecute ()
 
 //---------------------------------------------------------------------
 
+// public virtual [base kpCommand]
+QList <kpImage *> kpMacroCommand::storedImages ()
+{
+    QList <kpImage *> images;
+
+    foreach (kpCommand *command, m_commandList)
+    {
+        images += command->storedImages ();
+    }
+
+    return images;
+}
+
+//---------------------------------------------------------------------
+
 // public
 void kpMacroCommand::addCommand(kpCommand *command)
 {
@@ -51,6 +51,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 
     //
     // Interface
@@ -0,0 +1,180 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#define DEBUG_KP_UNDO_MEMORY_MANAGER 0
+
+
+#include "kpUndoMemoryManager.h"
+
+#include "kpCommandHistoryBase.h"
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+kpUndoMemoryManager::kpUndoMemoryManager ()
+    : m_globalSizeLimit (0),
+      m_isRebalancing (false)
+{
+}
+
+//---------------------------------------------------------------------
+
+// public static
+kpUndoMemoryManager *kpUndoMemoryManager::instance ()
+{
+    static kpUndoMemoryManager manager;
+    return &manager;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpUndoMemoryManager::globalSizeLimit () const
+{
+    return m_globalSizeLimit;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpUndoMemoryManager::setGlobalSizeLimit (kpCommandSize::SizeType sizeLimit)
+{
+    if (sizeLimit < 0)
+    {
+        qCCritical(kpLogCommands) << "kpUndoMemoryManager::setGlobalSizeLimit("
+                   << sizeLimit << ")";
+        return;
+    }
+
+    if (sizeLimit == m_globalSizeLimit) {
+        return;
+    }
+
+    m_globalSizeLimit = sizeLimit;
+    rebalance ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpUndoMemoryManager::totalResidentSize () const
+{
+    kpCommandSize::SizeType total = 0;
+
+    for (const kpCommandHistoryBase *history : m_histories) {
+        total += history->residentSize ();
+    }
+
+    return total;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpUndoMemoryManager::registerHistory (kpCommandHistoryBase *history)
+{
+    Q_ASSERT (!m_histories.contains (history));
+
+    m_histories.append (history);
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpUndoMemoryManager::unregisterHistory (kpCommandHistoryBase *history)
+{
+    m_histories.removeOne (history);
+
+    // (the others may now have more room)
+    rebalance ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpUndoMemoryManager::historyUsed (kpCommandHistoryBase *history)
+{
+    if (!m_histories.isEmpty () && m_histories.last () == history) {
+        return;
+    }
+
+    m_histories.removeOne (history);
+    m_histories.append (history);
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpUndoMemoryManager::historyChanged (kpCommandHistoryBase * /*history*/)
+{
+    // (called back by the histories that rebalance() trims)
+    if (m_isRebalancing) {
+        return;
+    }
+
+    rebalance ();
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpUndoMemoryManager::rebalance ()
+{
+    m_isRebalancing = true;
+
+    if (m_globalSizeLimit <= 0)
+    {
+        for (kpCommandHistoryBase *history : qAsConst (m_histories)) {
+            history->setSizeBudget (-1/*unlimited*/);
+        }
+    }
+    else
+    {
+        kpCommandSize::SizeType remaining = m_globalSizeLimit;
+
+        // Most recently used first.
+        for (int i = m_histories.size () - 1; i >= 0; i--)
+        {
+            kpCommandHistoryBase *history = m_histories [i];
+
+            history->setSizeBudget (remaining);
+            remaining = qMax (remaining - history->residentSize (),
+                              static_cast <kpCommandSize::SizeType> (0));
+        }
+
+    #if DEBUG_KP_UNDO_MEMORY_MANAGER
+        qCDebug(kpLogCommands) << "kpUndoMemoryManager::rebalance() limit="
+                               << m_globalSizeLimit
+                               << " remaining=" << remaining;
+    #endif
+    }
+
+    m_isRebalancing = false;
+}
+
+//---------------------------------------------------------------------
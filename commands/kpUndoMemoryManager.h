@@ -0,0 +1,100 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef kpUndoMemoryManager_H
+#define kpUndoMemoryManager_H
+
+
+#include <QList>
+
+#include "commands/kpCommandSize.h"
+
+
+class kpCommandHistoryBase;
+
+
+//
+// Shares one memory limit for undo/redo between all the command histories
+// (i.e. all windows) of the process.
+//
+// Every kpCommandHistoryBase registers itself here and reports when it has
+// been used or has changed.  If the histories hold more than
+// globalSizeLimit() in total, the most recently used history is given as
+// much of the limit as it needs (up to its own
+// kpCommandHistoryBase::undoMaxLimitSizeLimit()), then the next most
+// recently used one and so on.  So it is the histories that have not been
+// used for the longest that lose their oldest commands first.  Before a
+// command is deleted for this, its images are compressed and, if enabled,
+// spilled (see kpCommandImageCompressor).
+//
+// As with a history's own size limit, each history still keeps at least
+// kpCommandHistoryBase::undoMinLimit() commands.
+//
+class kpUndoMemoryManager
+{
+public:
+    static kpUndoMemoryManager *instance ();
+
+    // 0 (the default) means no global limit: each history is only limited
+    // by its own undoMaxLimitSizeLimit().
+    kpCommandSize::SizeType globalSizeLimit () const;
+    void setGlobalSizeLimit (kpCommandSize::SizeType sizeLimit);
+
+    // Returns the sum of the kpCommandHistoryBase::residentSize()'s.
+    kpCommandSize::SizeType totalResidentSize () const;
+
+
+    // interface for kpCommandHistoryBase
+
+    void registerHistory (kpCommandHistoryBase *history);
+    void unregisterHistory (kpCommandHistoryBase *history);
+
+    // Marks <history> as the most recently used.
+    void historyUsed (kpCommandHistoryBase *history);
+
+    // Called after <history> has trimmed itself, as its resident size may
+    // have grown.
+    void historyChanged (kpCommandHistoryBase *history);
+
+private:
+    kpUndoMemoryManager ();
+
+    // Hands out globalSizeLimit() to the histories, which trim themselves
+    // if their share shrinks.
+    void rebalance ();
+
+    // (least recently used first)
+    QList <kpCommandHistoryBase *> m_histories;
+
+    kpCommandSize::SizeType m_globalSizeLimit;
+
+    bool m_isRebalancing;
+};
+
+
+#endif  // kpUndoMemoryManager_H
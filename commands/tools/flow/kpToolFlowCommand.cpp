@@ -33,17 +33,27 @@
 
 #include "document/kpDocument.h"
 #include "imagelib/kpImage.h"
-#include "pixmapfx/kpPixmapFX.h"
-#include "tools/kpTool.h"
+#include "imagelib/kpImageTileStore.h"
 #include "views/manager/kpViewManager.h"
 
+#include <QElapsedTimer>
 #include <QRect>
+#include <QRegion>
 
 
 struct kpToolFlowCommandPrivate
 {
-    kpImage image;
+    // The tiles of the document that the stroke touched.  Before
+    // execute() (and after unexecute()), these hold the document pixels
+    // from before the stroke; otherwise, from after the stroke.
+    kpImageTileStore tiles;
+
+    // The tiles really drawn on, as opposed to just saved by
+    // aboutToModify(), and their bounds.
+    kpImageTileStore::TileMask dirtyTiles;
     QRect boundingRect;
+
+    QElapsedTimer finalizedTimer;
 };
 
 
@@ -51,7 +61,11 @@ kpToolFlowCommand::kpToolFlowCommand (const QString &name, kpCommandEnvironment
     : kpNamedCommand (name, environ),
       d (new kpToolFlowCommandPrivate ())
 {
-    d->image = document ()->image ();
+    // Don't take a (shared) copy of the document image: the first dab
+    // would detach it, duplicating the whole document.  Tiles are saved
+    // on demand by aboutToModify() instead.
+    d->tiles = kpImageTileStore (document ()->rect ());
+    d->dirtyTiles = d->tiles.tileMask ();
 }
 
 kpToolFlowCommand::~kpToolFlowCommand ()
@@ -63,7 +77,7 @@ kpToolFlowCommand::~kpToolFlowCommand ()
 // public virtual [base kpCommand]
 kpCommandSize::SizeType kpToolFlowCommand::size () const
 {
-    return ImageSize (d->image);
+    return d->tiles.size ();
 }
 
 
@@ -79,17 +93,48 @@ void kpToolFlowCommand::unexecute ()
     swapOldAndNew ();
 }
 
+// public virtual [base kpCommand]
+QList <kpImage *> kpToolFlowCommand::storedImages ()
+{
+    return d->tiles.tileImages ();
+}
+
+
+// private
+void kpToolFlowCommand::tilesChanged ()
+{
+    kpDocument *doc = document ();
+    Q_ASSERT (doc);
+
+    // Only repaint the tiles, not everything between them (e.g. the inside
+    // of an L-shaped stroke).
+    for (const QRect &rect : d->tiles.region ()) {
+        doc->slotContentsChanged (rect);
+    }
+}
 
 // private
 void kpToolFlowCommand::swapOldAndNew ()
 {
-    if (d->boundingRect.isValid ())
-    {
-        const kpImage oldImage = document ()->getImageAt (d->boundingRect);
+    if (d->tiles.isEmpty ()) {
+        return;
+    }
 
-        document ()->setImageAt (d->image, d->boundingRect.topLeft ());
+    d->tiles.swap (document ()->imagePointer ());
+    tilesChanged ();
+}
 
-        d->image = oldImage;
+// public
+void kpToolFlowCommand::aboutToModify (const QRect &docRect)
+{
+    d->tiles.saveTiles (*document ()->imagePointer (), docRect);
+}
+
+// public
+void kpToolFlowCommand::aboutToModify (const QRegion &docRegion)
+{
+    for (const QRect &docRect : docRegion) {
+        d->tiles.saveTiles (*document ()->imagePointer (), docRect);
     }
 }
 
@@ -109,32 +154,74 @@ void kpToolFlowCommand::updateBoundingRect (const QRect &rect)
                << rect;
 #endif
     d->boundingRect = d->boundingRect.united (rect);
+    d->tiles.addToTileMask (&d->dirtyTiles, rect);
 #if DEBUG_KP_TOOL_FLOW_COMMAND & 0
     qCDebug(kpLogCommands) << "\tresult=" << d->boundingRect;
 #endif
 }
 
+// public
+void kpToolFlowCommand::updateBoundingRect (const QRegion &region)
+{
+    d->boundingRect = d->boundingRect.united (region.boundingRect ());
+    for (const QRect &rect : region) {
+        d->tiles.addToTileMask (&d->dirtyTiles, rect);
+    }
+}
+
 // public
 void kpToolFlowCommand::finalize ()
 {
     if (d->boundingRect.isValid ())
     {
-        // Store only the needed part of doc image.
-        d->image = kpTool::neededPixmap (d->image, d->boundingRect);
+        // Forget tiles that were saved but not drawn on in the end.
+        d->tiles.removeTilesOutside (d->dirtyTiles);
     }
     else
     {
-        d->image = kpImage ();
+        d->tiles.clear ();
     }
+
+    d->finalizedTimer.start ();
 }
 
 // public
 void kpToolFlowCommand::cancel ()
 {
-    if (d->boundingRect.isValid ())
+    if (!d->tiles.isEmpty ())
     {
         viewManager ()->setFastUpdates ();
-        document ()->setImageAt (d->image, d->boundingRect.topLeft ());
+        d->tiles.restore (document ()->imagePointer ());
+        tilesChanged ();
         viewManager ()->restoreFastUpdates ();
     }
 }
+
+
+// public
+QRect kpToolFlowCommand::boundingRect () const
+{
+    return d->boundingRect;
+}
+
+// public
+qint64 kpToolFlowCommand::msecsSinceFinalized () const
+{
+    return d->finalizedTimer.isValid () ? d->finalizedTimer.elapsed () : -1;
+}
+
+// public
+void kpToolFlowCommand::absorb (kpToolFlowCommand *later)
+{
+    Q_ASSERT (later && later != this);
+
+    d->tiles.merge (later->d->tiles);
+    d->dirtyTiles |= later->d->dirtyTiles;
+    d->boundingRect = d->boundingRect.united (later->d->boundingRect);
+
+    later->d->tiles.clear ();
+    later->d->dirtyTiles.fill (false);
+    later->d->boundingRect = QRect ();
+
+    d->finalizedTimer.start ();
+}
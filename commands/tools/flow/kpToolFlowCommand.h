@@ -35,6 +35,7 @@
 
 class QPoint;
 class QRect;
+class QRegion;
 
 
 class kpToolFlowCommand : public kpNamedCommand
@@ -48,13 +49,39 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
     // interface for kpToolFlowBase
+
+    // Saves the parts of the document inside <docRect> (rounded out to
+    // whole tiles) that haven't been saved yet during this stroke.
+    //
+    // This must be called before modifying those parts of the document.
+    void aboutToModify (const QRect &docRect);
+    // (for a stroke that touches several separate parts of the document)
+    void aboutToModify (const QRegion &docRegion);
+
     void updateBoundingRect (const QPoint &point);
     void updateBoundingRect (const QRect &rect);
+    void updateBoundingRect (const QRegion &region);
     void finalize ();
     void cancel ();
 
+    // interface for kpCommandHistory
+
+    QRect boundingRect () const;
+
+    // Returns how long ago finalize() or absorb() was last called.
+    qint64 msecsSinceFinalized () const;
+
+    // Makes this command also undo <later>, the stroke drawn right after
+    // this one, which is then empty and can be deleted.  Both commands
+    // must have been executed.
+    void absorb (kpToolFlowCommand *later);
+
 private:
+    // Tells the document that the tiles changed.
+    void tilesChanged ();
     void swapOldAndNew ();
 
     struct kpToolFlowCommandPrivate * const d;
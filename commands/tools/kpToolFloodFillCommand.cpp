@@ -167,3 +167,11 @@ void kpToolFloodFillCommand::unexecute ()
 }
 
 //---------------------------------------------------------------------
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpToolFloodFillCommand::storedImages ()
+{
+    return {&d->oldImage};
+}
+
+//---------------------------------------------------------------------
@@ -60,6 +60,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 private:
     kpToolFloodFillCommandPrivate * const d;
 };
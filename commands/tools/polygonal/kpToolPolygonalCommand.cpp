@@ -34,6 +34,7 @@
 #include "document/kpDocument.h"
 #include "kpDefs.h"
 #include "imagelib/kpImage.h"
+#include "imagelib/kpImageTileStore.h"
 
 
 struct kpToolPolygonalCommandPrivate
@@ -47,7 +48,9 @@ struct kpToolPolygonalCommandPrivate
     int penWidth{};
     kpColor bcolor;
 
-    kpImage oldImage;
+    // The tiles of the document that the shape covers, from before it was
+    // drawn (only while executed).
+    kpImageTileStore oldTiles;
 };
 
 kpToolPolygonalCommand::kpToolPolygonalCommand (const QString &name,
@@ -81,7 +84,7 @@ kpToolPolygonalCommand::~kpToolPolygonalCommand ()
 kpCommandSize::SizeType kpToolPolygonalCommand::size () const
 {
     return PolygonSize (d->points) +
-           ImageSize (d->oldImage);
+           d->oldTiles.size ();
 }
 
 // public virtual [base kpCommand]
@@ -90,12 +93,8 @@ void kpToolPolygonalCommand::execute ()
     kpDocument *doc = document ();
     Q_ASSERT (doc);
 
-    // Store Undo info.
-    Q_ASSERT (d->oldImage.isNull ());
-    d->oldImage = doc->getImageAt (d->boundingRect);
-
     // Invoke shape drawing function passed in ctor.
-    kpImage image = d->oldImage;
+    kpImage image = doc->getImageAt (d->boundingRect);
 
     QPolygon pointsTranslated = d->points;
     pointsTranslated.translate (-d->boundingRect.x (), -d->boundingRect.y ());
@@ -106,6 +105,12 @@ void kpToolPolygonalCommand::execute ()
         d->bcolor,
         true/*final shape*/);
 
+    // Store Undo info: only the tiles that the shape really changes (for an
+    // outline, far fewer than the bounding rectangle).
+    Q_ASSERT (d->oldTiles.isEmpty ());
+    d->oldTiles = kpImageTileStore (doc->rect ());
+    d->oldTiles.saveChangedTiles (*doc->imagePointer (), image, d->boundingRect.topLeft ());
+
     doc->setImageAt (image, d->boundingRect.topLeft ());
 }
 
@@ -115,9 +120,18 @@ void kpToolPolygonalCommand::unexecute ()
     kpDocument *doc = document ();
     Q_ASSERT (doc);
 
-    Q_ASSERT (!d->oldImage.isNull ());
-    doc->setImageAt (d->oldImage, d->boundingRect.topLeft ());
+    if (!d->oldTiles.isEmpty ())
+    {
+        d->oldTiles.restore (doc->imagePointer ());
+        doc->slotContentsChanged (d->oldTiles.boundingRect ());
 
-    d->oldImage = kpImage ();
+        d->oldTiles.clear ();
+    }
 }
 
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpToolPolygonalCommand::storedImages ()
+{
+    return d->oldTiles.tileImages ();
+}
@@ -59,6 +59,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 private:
     struct kpToolPolygonalCommandPrivate * const d;
     kpToolPolygonalCommand &operator= (const kpToolPolygonalCommand &) const;
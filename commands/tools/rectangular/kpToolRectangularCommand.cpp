@@ -32,6 +32,7 @@
 #include "kpToolRectangularCommand.h"
 
 #include "imagelib/kpColor.h"
+#include "imagelib/kpImageTileStore.h"
 #include "kpDefs.h"
 #include "document/kpDocument.h"
 #include "imagelib/kpPainter.h"
@@ -55,7 +56,9 @@ struct kpToolRectangularCommandPrivate
     int penWidth{};
     kpColor bcolor;
 
-    kpImage oldImage;
+    // The tiles of the document that the shape covers, from before it was
+    // drawn (only while executed).
+    kpImageTileStore oldTiles;
 };
 
 kpToolRectangularCommand::kpToolRectangularCommand (const QString &name,
@@ -86,7 +89,7 @@ kpToolRectangularCommand::~kpToolRectangularCommand ()
 // public virtual [base kpCommand]
 kpCommandSize::SizeType kpToolRectangularCommand::size () const
 {
-    return ImageSize (d->oldImage);
+    return d->oldTiles.size ();
 }
 
 
@@ -96,19 +99,19 @@ void kpToolRectangularCommand::execute ()
     kpDocument *doc = document ();
     Q_ASSERT (doc);
 
-    // Store Undo info.
-    // OPT: For a pure rectangle, can do better if there is no bcolor, by only
-    //      saving 4 pixmaps corresponding to the pixels dirtied by the 4 edges.
-    Q_ASSERT (d->oldImage.isNull ());
-    d->oldImage = doc->getImageAt (d->rect);
-
     // Invoke shape drawing function passed in ctor.
-    kpImage image = d->oldImage;
+    kpImage image = doc->getImageAt (d->rect);
     (*d->drawShapeFunc) (&image,
         0, 0, d->rect.width (), d->rect.height (),
         d->fcolor, d->penWidth,
         d->bcolor);
 
+    // Store Undo info: only the tiles that the shape really changes (for an
+    // outline, far fewer than the bounding rectangle).
+    Q_ASSERT (d->oldTiles.isEmpty ());
+    d->oldTiles = kpImageTileStore (doc->rect ());
+    d->oldTiles.saveChangedTiles (*doc->imagePointer (), image, d->rect.topLeft ());
+
     doc->setImageAt (image, d->rect.topLeft ());
 }
 
@@ -118,9 +121,18 @@ void kpToolRectangularCommand::unexecute ()
     kpDocument *doc = document ();
     Q_ASSERT (doc);
 
-    Q_ASSERT (!d->oldImage.isNull ());
-    doc->setImageAt (d->oldImage, d->rect.topLeft ());
+    if (!d->oldTiles.isEmpty ())
+    {
+        d->oldTiles.restore (doc->imagePointer ());
+        doc->slotContentsChanged (d->oldTiles.boundingRect ());
 
-    d->oldImage = kpImage ();
+        d->oldTiles.clear ();
+    }
 }
 
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpToolRectangularCommand::storedImages ()
+{
+    return d->oldTiles.tileImages ();
+}
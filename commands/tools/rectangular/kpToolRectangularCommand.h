@@ -53,6 +53,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 private:
     struct kpToolRectangularCommandPrivate * const d;
     kpToolRectangularCommand &operator= (const kpToolRectangularCommand &) const;
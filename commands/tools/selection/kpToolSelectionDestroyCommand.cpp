@@ -174,3 +174,9 @@ void kpToolSelectionDestroyCommand::unexecute ()
     m_oldSelectionPtr = nullptr;
 }
 
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpToolSelectionDestroyCommand::storedImages ()
+{
+    return {&m_oldDocImage};
+}
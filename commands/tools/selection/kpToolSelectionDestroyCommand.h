@@ -49,6 +49,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
 private:
     bool m_pushOntoDocument;
     kpImage m_oldDocImage;
@@ -217,3 +217,9 @@ void kpToolSelectionMoveCommand::finalize ()
     }
 }
 
+
+// public virtual [base kpCommand]
+QList <kpImage *> kpToolSelectionMoveCommand::storedImages ()
+{
+    return {&m_oldDocumentImage};
+}
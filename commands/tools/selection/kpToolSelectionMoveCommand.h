@@ -54,6 +54,8 @@ public:
     void execute () override;
     void unexecute () override;
 
+    QList <kpImage *> storedImages () override;
+
     void moveTo (const QPoint &point, bool moveLater = false);
     void moveTo (int x, int y, bool moveLater = false);
     void copyOntoDocument ();
@@ -0,0 +1,189 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "kpCommandTimingsDialog.h"
+
+#include "commands/kpCommandTimings.h"
+
+#include <KLocalizedString>
+#include <KMessageBox>
+
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+//---------------------------------------------------------------------
+
+enum
+{
+    ColumnCommand,
+    ColumnOperation,
+    ColumnStart,
+    ColumnDuration,
+    ColumnExtraMemory,
+    ColumnPixelsTouched
+};
+
+//---------------------------------------------------------------------
+
+// (sorts numerically by the number in Qt::UserRole, where there is one)
+class kpCommandTimingsDialogItem : public QTreeWidgetItem
+{
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+    bool operator< (const QTreeWidgetItem &other) const override
+    {
+        const int column = treeWidget () ? treeWidget ()->sortColumn () : 0;
+
+        const QVariant value = data (column, Qt::UserRole);
+        if (!value.isValid ()) {
+            return QTreeWidgetItem::operator< (other);
+        }
+
+        return value.toLongLong () < other.data (column, Qt::UserRole).toLongLong ();
+    }
+};
+
+//---------------------------------------------------------------------
+
+kpCommandTimingsDialog::kpCommandTimingsDialog (kpCommandTimings *timings,
+        QWidget *parent)
+    : QDialog (parent),
+      m_timings (timings)
+{
+    Q_ASSERT (m_timings);
+
+    setWindowTitle (i18nc ("@title:window", "Command Timings"));
+
+    m_recordsWidget = new QTreeWidget (this);
+    m_recordsWidget->setRootIsDecorated (false);
+    m_recordsWidget->setSortingEnabled (true);
+    m_recordsWidget->setHeaderLabels ({
+        i18nc ("@title:column", "Command"),
+        i18nc ("@title:column", "Operation"),
+        i18nc ("@title:column", "Start (ms)"),
+        i18nc ("@title:column", "Duration (ms)"),
+        i18nc ("@title:column", "Extra Memory (KiB)"),
+        i18nc ("@title:column", "Pixels Touched")});
+
+    auto *buttons = new QDialogButtonBox (QDialogButtonBox::Close, this);
+    QPushButton *exportButton = buttons->addButton (i18n ("&Export Trace..."),
+        QDialogButtonBox::ActionRole);
+    QPushButton *clearButton = buttons->addButton (i18n ("C&lear"),
+        QDialogButtonBox::ResetRole);
+
+    connect (exportButton, &QPushButton::clicked, this, &kpCommandTimingsDialog::slotExport);
+    connect (clearButton, &QPushButton::clicked, this, &kpCommandTimingsDialog::slotClear);
+    connect (buttons, &QDialogButtonBox::rejected, this, &kpCommandTimingsDialog::reject);
+
+    auto *dialogLayout = new QVBoxLayout (this);
+    dialogLayout->addWidget (m_recordsWidget);
+    dialogLayout->addWidget (buttons);
+
+    resize (720, 480);
+
+    updateRecords ();
+}
+
+//---------------------------------------------------------------------
+
+kpCommandTimingsDialog::~kpCommandTimingsDialog () = default;
+
+//---------------------------------------------------------------------
+
+// private
+void kpCommandTimingsDialog::updateRecords ()
+{
+    m_recordsWidget->clear ();
+
+    for (const kpCommandTimings::Record &record : m_timings->records ())
+    {
+        auto *item = new kpCommandTimingsDialogItem (m_recordsWidget);
+
+        item->setText (ColumnCommand, record.commandName);
+        item->setText (ColumnOperation, record.isUnexecute ?
+            i18n ("Undo") : i18n ("Do"));
+
+        const auto setNumber = [item] (int column, const QString &text, qint64 value) {
+            item->setText (column, text);
+            item->setData (column, Qt::UserRole, value);
+            item->setTextAlignment (column, Qt::AlignRight | Qt::AlignVCenter);
+        };
+
+        setNumber (ColumnStart,
+            QString::number (record.startNsecs / 1e6, 'f', 1), record.startNsecs);
+        setNumber (ColumnDuration,
+            QString::number (record.durationNsecs / 1e6, 'f', 3), record.durationNsecs);
+        setNumber (ColumnExtraMemory,
+            QString::number (record.extraMemory / 1024), record.extraMemory);
+        setNumber (ColumnPixelsTouched,
+            QString::number (record.pixelsTouched), record.pixelsTouched);
+    }
+
+    m_recordsWidget->sortByColumn (ColumnStart, Qt::AscendingOrder);
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpCommandTimingsDialog::slotExport ()
+{
+    const QString fileName = QFileDialog::getSaveFileName (this,
+        i18nc ("@title:window", "Export Command Timings"),
+        QStringLiteral ("kolourpaint-timings.json"),
+        i18n ("Chrome Trace (*.json)"));
+    if (fileName.isEmpty ()) {
+        return;
+    }
+
+    const QByteArray trace = m_timings->toChromeTrace ();
+
+    QSaveFile file (fileName);
+    if (!file.open (QIODevice::WriteOnly) ||
+        file.write (trace) != trace.size () ||
+        !file.commit ())
+    {
+        KMessageBox::sorry (this,
+            i18n ("Could not save the command timings to \"%1\".", fileName));
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private slot
+void kpCommandTimingsDialog::slotClear ()
+{
+    m_timings->clear ();
+    updateRecords ();
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,65 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef kpCommandTimingsDialog_H
+#define kpCommandTimingsDialog_H
+
+
+#include <QDialog>
+
+
+class QTreeWidget;
+
+class kpCommandTimings;
+
+
+// Debug dialog listing the records of a kpCommandTimings, slowest
+// operations being easy to find by sorting on the duration column.
+// The records can also be exported as a Chrome trace.
+class kpCommandTimingsDialog : public QDialog
+{
+Q_OBJECT
+
+public:
+    kpCommandTimingsDialog (kpCommandTimings *timings, QWidget *parent);
+    ~kpCommandTimingsDialog () override;
+
+private slots:
+    void slotExport ();
+    void slotClear ();
+
+private:
+    void updateRecords ();
+
+    kpCommandTimings *m_timings;
+
+    QTreeWidget *m_recordsWidget;
+};
+
+
+#endif  // kpCommandTimingsDialog_H
@@ -316,6 +316,35 @@ kpImage kpDocument::getImageAt (const QRect &rect) const
 
 //---------------------------------------------------------------------
 
+// public
+kpImage kpDocument::getImageViewAt (const QRect &rect) const
+{
+    const QRect viewRect = rect.intersected (m_image->rect ());
+    if (viewRect.isEmpty ()) {
+        return {};
+    }
+
+    // Pixels of sub-byte formats can't be addressed with a byte offset
+    // into the scanline.
+    if (m_image->depth () < 8) {
+        return getImageAt (viewRect);
+    }
+
+    const uchar *bits = m_image->constScanLine (viewRect.y ()) +
+        viewRect.x () * (m_image->depth () / 8);
+
+    // (the const uchar * constructor never writes to <bits>)
+    kpImage ret (bits, viewRect.width (), viewRect.height (),
+                 m_image->bytesPerLine (), m_image->format ());
+    if (m_image->format () == QImage::Format_Indexed8) {
+        ret.setColorTable (m_image->colorTable ());
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
 // public
 void kpDocument::setImageAt (const kpImage &image, const QPoint &at)
 {
@@ -188,6 +188,16 @@ public:
     // selection).
     kpImage getImageAt (const QRect &rect) const;
 
+    // Returns a read-only view of part of the document's image (not
+    // including the selection), clipped to rect().  Unlike getImageAt(),
+    // no pixels are copied: the returned image shares the document's
+    // scanline memory.  Painting onto it detaches it into a deep copy,
+    // so the document is never modified through it.
+    //
+    // WARNING: The view is only valid until the document's image is next
+    //          changed.  Do not store it -- use getImageAt() for that.
+    kpImage getImageViewAt (const QRect &rect) const;
+
     void setImageAt (const kpImage &image, const QPoint &at);
 
     // "image(false)" returns a copy of the document's image, ignoring any
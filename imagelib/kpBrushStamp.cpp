@@ -0,0 +1,190 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "kpBrushStamp.h"
+
+#include <climits>
+
+#include "imagelib/kpColor.h"
+
+//---------------------------------------------------------------------
+
+kpBrushStamp::kpBrushStamp ()
+    : m_width (0),
+      m_height (0)
+{
+}
+
+//---------------------------------------------------------------------
+
+kpBrushStamp::kpBrushStamp (kpTempImage::UserFunctionType drawFunc, void *drawFuncData,
+        int width, int height)
+    : m_width (0),
+      m_height (0)
+{
+    if (!drawFunc || width <= 0 || height <= 0) {
+        return;
+    }
+
+    kpImage image (width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill (0);
+
+    (*drawFunc) (&image, QPoint (0, 0), drawFuncData);
+
+    m_width = width;
+    m_height = height;
+    m_coverage.resize (width * height);
+
+    for (int y = 0; y < height; y++)
+    {
+        const auto *line = reinterpret_cast <const QRgb *> (image.constScanLine (y));
+        for (int x = 0; x < width; x++)
+        {
+            m_coverage [y * width + x] = (qAlpha (line [x]) != 0) ? 1 : 0;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpBrushStamp::isNull () const
+{
+    return m_coverage.isEmpty ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+QSize kpBrushStamp::size () const
+{
+    return {m_width, m_height};
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpBrushStamp::canDrawOn (const kpImage &image) const
+{
+    return !isNull () && image.format () == QImage::Format_ARGB32_Premultiplied;
+}
+
+//---------------------------------------------------------------------
+
+// Returns <src> composited over <dest> (both premultiplied).
+static inline QRgb SourceOver (QRgb src, QRgb dest)
+{
+    const uint inverseAlpha = 255 - qAlpha (src);
+
+    const auto channel = [inverseAlpha] (uint s, uint d) {
+        // (d * inverseAlpha / 255, rounded)
+        uint t = d * inverseAlpha + 128;
+        return s + ((t + (t >> 8)) >> 8);
+    };
+
+    return qRgba (channel (qRed (src), qRed (dest)),
+                  channel (qGreen (src), qGreen (dest)),
+                  channel (qBlue (src), qBlue (dest)),
+                  channel (qAlpha (src), qAlpha (dest)));
+}
+
+//---------------------------------------------------------------------
+
+// public
+QRect kpBrushStamp::draw (kpImage *image, const QList <QPoint> &topLefts,
+        const kpColor &color) const
+{
+    Q_ASSERT (image && canDrawOn (*image));
+
+    QRect stampsRect;
+    for (const QPoint &topLeft : topLefts)
+    {
+        stampsRect = stampsRect.united (QRect (topLeft, size ()));
+    }
+
+    const QRect rect = stampsRect.intersected (image->rect ());
+
+    const QRgb src = qPremultiply (color.toQRgb ());
+    const bool isOpaque = (qAlpha (src) == 255);
+
+    // (source over with a fully transparent color does nothing)
+    if (rect.isEmpty () || qAlpha (src) == 0) {
+        return {};
+    }
+
+    // OR the coverage of each stamp into a mask of <rect>.
+    QVector <quint8> mask (rect.width () * rect.height (), 0);
+
+    for (const QPoint &topLeft : topLefts)
+    {
+        const QRect stampRect = QRect (topLeft, size ()).intersected (rect);
+
+        for (int y = stampRect.top (); y <= stampRect.bottom (); y++)
+        {
+            const quint8 *coverage = m_coverage.constData () +
+                (y - topLeft.y ()) * m_width + (stampRect.left () - topLeft.x ());
+            quint8 *maskLine = mask.data () +
+                (y - rect.top ()) * rect.width () + (stampRect.left () - rect.left ());
+
+            for (int x = 0; x < stampRect.width (); x++) {
+                maskLine [x] |= coverage [x];
+            }
+        }
+    }
+
+    // Write each covered pixel once.
+    QRect dirtyRect;
+    for (int y = rect.top (); y <= rect.bottom (); y++)
+    {
+        const quint8 *maskLine = mask.constData () + (y - rect.top ()) * rect.width ();
+        auto *line = reinterpret_cast <QRgb *> (image->scanLine (y)) + rect.left ();
+
+        int minX = INT_MAX, maxX = -1;
+        for (int x = 0; x < rect.width (); x++)
+        {
+            if (!maskLine [x]) {
+                continue;
+            }
+
+            line [x] = isOpaque ? src : ::SourceOver (src, line [x]);
+
+            minX = qMin (minX, x);
+            maxX = x;
+        }
+
+        if (maxX >= 0)
+        {
+            dirtyRect = dirtyRect.united (
+                QRect (rect.left () + minX, y, maxX - minX + 1, 1));
+        }
+    }
+
+    return dirtyRect;
+}
+
+//---------------------------------------------------------------------
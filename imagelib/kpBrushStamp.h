@@ -0,0 +1,89 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef kpBrushStamp_H
+#define kpBrushStamp_H
+
+
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+#include "imagelib/kpImage.h"
+#include "layers/tempImage/kpTempImage.h"
+
+
+class kpColor;
+
+
+//
+// Draws a brush repeatedly along a stroke, straight into an image's
+// memory.
+//
+// The pixels that the brush covers are worked out once, when the stamp is
+// constructed, by running the brush's kpTempImage::UserFunctionType on a
+// blank image.  Drawing then ORs the coverage of every stamp position into
+// a mask and composites the color into each covered pixel exactly once.
+// This is much faster than calling the brush function (and so creating a
+// QPainter) per position, and pixels that consecutive positions overlap
+// are not blended more than once.
+//
+class kpBrushStamp
+{
+public:
+    kpBrushStamp ();
+
+    // <drawFuncData> must make <drawFunc> draw in an opaque color.
+    kpBrushStamp (kpTempImage::UserFunctionType drawFunc, void *drawFuncData,
+                  int width, int height);
+
+    bool isNull () const;
+    QSize size () const;
+
+    // Returns whether draw() can be used on <image> (it only handles
+    // QImage::Format_ARGB32_Premultiplied, which is what documents use).
+    bool canDrawOn (const kpImage &image) const;
+
+    // Draws the brush in <color>, with its top-left at each of <topLefts>,
+    // as QPainter's default (source over) composition would.
+    //
+    // Returns the dirty rectangle.
+    QRect draw (kpImage *image, const QList <QPoint> &topLefts,
+                const kpColor &color) const;
+
+private:
+    int m_width, m_height;
+
+    // (1 for each pixel covered by the brush, row by row)
+    QVector <quint8> m_coverage;
+};
+
+
+#endif  // kpBrushStamp_H
@@ -0,0 +1,328 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#define DEBUG_KP_IMAGE_DELTA 0
+
+
+#include "kpImageDelta.h"
+
+#include <cstring>
+
+#include <QVector>
+
+#include "kpLogCategories.h"
+
+//---------------------------------------------------------------------
+
+// public static
+const int kpImageDelta::TileSize = 64;
+
+//---------------------------------------------------------------------
+
+// Each tile starts with one of these bytes.
+static const char TileUnchanged = 0;
+static const char TileEncoded = 1;
+
+// Shorter runs of identical words are cheaper to store as literals.
+static const int MinRunLength = 3;
+
+//---------------------------------------------------------------------
+
+static void AppendCount (QByteArray *data, quint32 count)
+{
+    // (7 bits at a time, least significant first)
+    while (count >= 0x80)
+    {
+        data->append (static_cast <char> ((count & 0x7F) | 0x80));
+        count >>= 7;
+    }
+
+    data->append (static_cast <char> (count));
+}
+
+static quint32 ReadCount (const char **p)
+{
+    quint32 count = 0;
+    int shift = 0;
+
+    uchar byte;
+    do
+    {
+        byte = static_cast <uchar> (*(*p)++);
+        count |= static_cast <quint32> (byte & 0x7F) << shift;
+        shift += 7;
+    }
+    while (byte & 0x80);
+
+    return count;
+}
+
+//---------------------------------------------------------------------
+
+static void AppendWord (QByteArray *data, quint32 word)
+{
+    data->append (reinterpret_cast <const char *> (&word), sizeof (word));
+}
+
+static quint32 ReadWord (const char **p)
+{
+    quint32 word;
+    std::memcpy (&word, *p, sizeof (word));
+    *p += sizeof (word);
+
+    return word;
+}
+
+//---------------------------------------------------------------------
+
+static bool RunStartsAt (const QVector <quint32> &words, int i)
+{
+    if (i + MinRunLength > words.size ()) {
+        return false;
+    }
+
+    for (int j = 1; j < MinRunLength; j++)
+    {
+        if (words [i + j] != words [i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+
+// Appends the run-length encoding of <words> to <data>.
+//
+// Each chunk is a count, shifted left by one, with the bottom bit set for
+// a run.  A run is followed by the single word that is repeated <count>
+// times.  Otherwise, <count> literal words follow.
+static void EncodeWords (QByteArray *data, const QVector <quint32> &words)
+{
+    const int n = words.size ();
+
+    int i = 0;
+    while (i < n)
+    {
+        if (::RunStartsAt (words, i))
+        {
+            int run = MinRunLength;
+            while (i + run < n && words [i + run] == words [i]) {
+                run++;
+            }
+
+            ::AppendCount (data, (static_cast <quint32> (run) << 1) | 1);
+            ::AppendWord (data, words [i]);
+
+            i += run;
+            continue;
+        }
+
+        const int start = i;
+        do
+        {
+            i++;
+        }
+        while (i < n && !::RunStartsAt (words, i));
+
+        ::AppendCount (data, static_cast <quint32> (i - start) << 1);
+        for (int j = start; j < i; j++) {
+            ::AppendWord (data, words [j]);
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+kpImageDelta::kpImageDelta ()
+    : m_format (QImage::Format_Invalid)
+{
+}
+
+//---------------------------------------------------------------------
+
+kpImageDelta::kpImageDelta (const kpImage &image, const kpImage &reference)
+    : m_format (QImage::Format_Invalid)
+{
+    if (image.isNull () ||
+        image.size () != reference.size () ||
+        image.format () != reference.format () ||
+        image.depth () != 32)
+    {
+        return;
+    }
+
+    const kpCommandSize::SizeType rawSize = kpCommandSize::ImageSize (image);
+
+    QByteArray data;
+
+    QVector <quint32> words;
+    words.reserve (TileSize * TileSize);
+
+    for (int tileY = 0; tileY < image.height (); tileY += TileSize)
+    {
+        const int tileHeight = qMin (TileSize, image.height () - tileY);
+
+        for (int tileX = 0; tileX < image.width (); tileX += TileSize)
+        {
+            const int tileWidth = qMin (TileSize, image.width () - tileX);
+
+            words.resize (0);
+            quint32 changed = 0;
+
+            for (int y = tileY; y < tileY + tileHeight; y++)
+            {
+                const auto *imageLine = reinterpret_cast <const quint32 *> (
+                    image.constScanLine (y)) + tileX;
+                const auto *referenceLine = reinterpret_cast <const quint32 *> (
+                    reference.constScanLine (y)) + tileX;
+
+                for (int x = 0; x < tileWidth; x++)
+                {
+                    const quint32 word = imageLine [x] ^ referenceLine [x];
+                    changed |= word;
+                    words.append (word);
+                }
+            }
+
+            if (!changed)
+            {
+                data.append (TileUnchanged);
+                continue;
+            }
+
+            data.append (TileEncoded);
+            ::EncodeWords (&data, words);
+
+            if (data.size () >= rawSize)
+            {
+            #if DEBUG_KP_IMAGE_DELTA
+                qCDebug(kpLogImagelib) << "kpImageDelta: not smaller than"
+                                       << rawSize << "bytes - giving up";
+            #endif
+                return;
+            }
+        }
+    }
+
+#if DEBUG_KP_IMAGE_DELTA
+    qCDebug(kpLogImagelib) << "kpImageDelta: " << rawSize << "->" << data.size ()
+                           << "bytes";
+#endif
+
+    m_imageSize = image.size ();
+    m_format = image.format ();
+
+    m_data = data;
+    m_data.squeeze ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpImageDelta::isNull () const
+{
+    return m_data.isEmpty ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpImageDelta::size () const
+{
+    return m_data.size ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpImage kpImageDelta::decode (const kpImage &reference) const
+{
+    if (isNull ()) {
+        return {};
+    }
+
+    kpImage image = reference.convertToFormat (m_format);
+    if (image.size () != m_imageSize)
+    {
+        qCCritical(kpLogImagelib) << "kpImageDelta::decode() reference size="
+                                  << reference.size () << "expected=" << m_imageSize;
+        return {};
+    }
+
+    const char *p = m_data.constData ();
+
+    for (int tileY = 0; tileY < image.height (); tileY += TileSize)
+    {
+        const int tileHeight = qMin (TileSize, image.height () - tileY);
+
+        for (int tileX = 0; tileX < image.width (); tileX += TileSize)
+        {
+            const int tileWidth = qMin (TileSize, image.width () - tileX);
+
+            if (*p++ == TileUnchanged) {
+                continue;
+            }
+
+            // XOR the decoded words back into the tile, in row-major order.
+            int x = 0, y = tileY;
+            auto *line = reinterpret_cast <quint32 *> (image.scanLine (y)) + tileX;
+
+            const int tileArea = tileWidth * tileHeight;
+            int done = 0;
+            while (done < tileArea)
+            {
+                const quint32 chunk = ::ReadCount (&p);
+                const bool isRun = (chunk & 1);
+                const int count = static_cast <int> (chunk >> 1);
+
+                const quint32 runWord = isRun ? ::ReadWord (&p) : 0;
+
+                for (int i = 0; i < count; i++)
+                {
+                    line [x] ^= isRun ? runWord : ::ReadWord (&p);
+
+                    if (++x == tileWidth && ++y < tileY + tileHeight)
+                    {
+                        x = 0;
+                        line = reinterpret_cast <quint32 *> (image.scanLine (y)) + tileX;
+                    }
+                }
+
+                done += count;
+            }
+        }
+    }
+
+    Q_ASSERT (p == m_data.constData () + m_data.size ());
+
+    return image;
+}
+
+//---------------------------------------------------------------------
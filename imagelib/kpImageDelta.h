@@ -0,0 +1,89 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef KP_IMAGE_DELTA_H
+#define KP_IMAGE_DELTA_H
+
+
+#include <QByteArray>
+#include <QSize>
+
+#include "imagelib/kpImage.h"
+#include "commands/kpCommandSize.h"
+
+
+//
+// A compact encoding of an image, relative to a reference image of the same
+// size (e.g. the image that an effect turned it into).
+//
+// The image is divided into TileSize x TileSize tiles.  For each tile, the
+// pixels of the image are XORed with those of the reference and the result
+// is run-length encoded.  Tiles that are the same in both images cost a
+// single byte.  So when only a few pixels differ, or they differ in flat
+// areas, this is a lot smaller than a copy of the image.
+//
+// Only 32-bit images are supported.
+//
+class kpImageDelta
+{
+public:
+    static const int TileSize;
+
+    // Constructs a null delta.
+    kpImageDelta ();
+
+    // Encodes <image> relative to <reference>.
+    //
+    // The delta is null if the images have different sizes or formats, are
+    // not 32-bit or if the encoding would not be smaller than
+    // kpCommandSize::ImageSize (<image>).  In those cases, the caller should
+    // just keep a copy of <image>.
+    kpImageDelta (const kpImage &image, const kpImage &reference);
+
+
+    bool isNull () const;
+
+    // Returns the size of the encoding.
+    kpCommandSize::SizeType size () const;
+
+
+    // Returns the image that the delta was constructed from.
+    //
+    // <reference> must have the same pixels as the reference given to the
+    // constructor.
+    kpImage decode (const kpImage &reference) const;
+
+
+private:
+    QSize m_imageSize;
+    QImage::Format m_format;
+    QByteArray m_data;
+};
+
+
+#endif  // KP_IMAGE_DELTA_H
@@ -0,0 +1,249 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+
+#define DEBUG_KP_IMAGE_SUMMED_AREA_TABLE 0
+
+
+#include "kpImageSummedAreaTable.h"
+
+#include "kpLogCategories.h"
+
+#include "imagelib/kpColor.h"
+#include "imagelib/kpImageTileStore.h"
+
+//---------------------------------------------------------------------
+
+kpImageSummedAreaTable::kpImageSummedAreaTable () = default;
+
+//---------------------------------------------------------------------
+
+// public
+bool kpImageSummedAreaTable::isEmpty () const
+{
+    return m_tables.isEmpty ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageSummedAreaTable::clear ()
+{
+    m_tables.clear ();
+    m_imageSize = QSize ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageSummedAreaTable::invalidate (const QRect &rect)
+{
+    const QRect imageRect (QPoint (0, 0), m_imageSize);
+    const QRect clippedRect = rect.intersected (imageRect);
+    if (clippedRect.isEmpty () || m_tables.isEmpty ()) {
+        return;
+    }
+
+#if DEBUG_KP_IMAGE_SUMMED_AREA_TABLE
+    qCDebug(kpLogImagelib) << "kpImageSummedAreaTable::invalidate(" << rect << ")";
+#endif
+
+    const int tileSize = kpImageTileStore::TileSize;
+    for (int tileY = clippedRect.top () / tileSize;
+         tileY <= clippedRect.bottom () / tileSize;
+         tileY++)
+    {
+        for (int tileX = clippedRect.left () / tileSize;
+             tileX <= clippedRect.right () / tileSize;
+             tileX++)
+        {
+            m_tables.remove (tileY * tilesAcross () + tileX);
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+int kpImageSummedAreaTable::tilesAcross () const
+{
+    const int tileSize = kpImageTileStore::TileSize;
+    return (m_imageSize.width () + tileSize - 1) / tileSize;
+}
+
+//---------------------------------------------------------------------
+
+// private
+QRect kpImageSummedAreaTable::tileRect (int tileX, int tileY) const
+{
+    const int tileSize = kpImageTileStore::TileSize;
+    return QRect (tileX * tileSize, tileY * tileSize, tileSize, tileSize)
+        .intersected (QRect (QPoint (0, 0), m_imageSize));
+}
+
+//---------------------------------------------------------------------
+
+// private static
+kpImageSummedAreaTable::Table kpImageSummedAreaTable::BuildTable (
+        const kpImage &image, const QRect &tileRect)
+{
+    // Documents are always premultiplied so this conversion is normally a
+    // NOP but other formats still work.
+    const kpImage *pixels = &image;
+    QPoint pixelsTopLeft = tileRect.topLeft ();
+    kpImage converted;
+    if (image.format () != QImage::Format_ARGB32_Premultiplied)
+    {
+        converted = image.copy (tileRect).convertToFormat (
+            QImage::Format_ARGB32_Premultiplied);
+        pixels = &converted;
+        pixelsTopLeft = QPoint (0, 0);
+    }
+
+    const int width = tileRect.width (), height = tileRect.height ();
+    const int stride = width + 1;
+
+    Table table (stride * (height + 1));
+    Sums *sums = table.data ();
+
+    // Row 0 and column 0 stay 0.
+    for (int y = 0; y < height; y++)
+    {
+        const QRgb *line = reinterpret_cast <const QRgb *> (
+            pixels->constScanLine (pixelsTopLeft.y () + y)) + pixelsTopLeft.x ();
+        const Sums *above = sums + y * stride;
+        Sums *here = sums + (y + 1) * stride;
+
+        Sums rowSums = {0, 0, 0, 0};
+        for (int x = 0; x < width; x++)
+        {
+            const QRgb pixel = line [x];
+            rowSums.alpha += qAlpha (pixel);
+            rowSums.red += qRed (pixel);
+            rowSums.green += qGreen (pixel);
+            rowSums.blue += qBlue (pixel);
+
+            here [x + 1].alpha = above [x + 1].alpha + rowSums.alpha;
+            here [x + 1].red = above [x + 1].red + rowSums.red;
+            here [x + 1].green = above [x + 1].green + rowSums.green;
+            here [x + 1].blue = above [x + 1].blue + rowSums.blue;
+        }
+    }
+
+    return table;
+}
+
+//---------------------------------------------------------------------
+
+// private
+const kpImageSummedAreaTable::Table &kpImageSummedAreaTable::table (
+        const kpImage &image, int tileX, int tileY)
+{
+    const int index = tileY * tilesAcross () + tileX;
+
+    auto it = m_tables.find (index);
+    if (it == m_tables.end ())
+    {
+    #if DEBUG_KP_IMAGE_SUMMED_AREA_TABLE
+        qCDebug(kpLogImagelib) << "kpImageSummedAreaTable::table() building tile"
+                               << tileX << tileY;
+    #endif
+        it = m_tables.insert (index, BuildTable (image, tileRect (tileX, tileY)));
+    }
+
+    return *it;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpColor kpImageSummedAreaTable::averageColor (const kpImage &image,
+        const QRect &rect)
+{
+    if (image.size () != m_imageSize)
+    {
+        // A different image - none of the tables apply.
+        m_tables.clear ();
+        m_imageSize = image.size ();
+    }
+
+    const QRect clippedRect = rect.intersected (image.rect ());
+    if (clippedRect.isEmpty ()) {
+        return kpColor::Invalid;
+    }
+
+    // (a 64x64 tile sums to at most 64*64*255 per channel, so the tables
+    //  fit in 32 bits but the whole rectangle might not)
+    quint64 alpha = 0, red = 0, green = 0, blue = 0;
+
+    const int tileSize = kpImageTileStore::TileSize;
+    for (int tileY = clippedRect.top () / tileSize;
+         tileY <= clippedRect.bottom () / tileSize;
+         tileY++)
+    {
+        for (int tileX = clippedRect.left () / tileSize;
+             tileX <= clippedRect.right () / tileSize;
+             tileX++)
+        {
+            const QRect tile = tileRect (tileX, tileY);
+            const QRect part = clippedRect.intersected (tile)
+                .translated (-tile.topLeft ());
+            const int stride = tile.width () + 1;
+
+            const Table &sums = table (image, tileX, tileY);
+            const Sums &topLeft = sums [part.top () * stride + part.left ()];
+            const Sums &topRight = sums [part.top () * stride + part.right () + 1];
+            const Sums &bottomLeft = sums [(part.bottom () + 1) * stride + part.left ()];
+            const Sums &bottomRight = sums [(part.bottom () + 1) * stride + part.right () + 1];
+
+            alpha += bottomRight.alpha - topRight.alpha - bottomLeft.alpha + topLeft.alpha;
+            red += bottomRight.red - topRight.red - bottomLeft.red + topLeft.red;
+            green += bottomRight.green - topRight.green - bottomLeft.green + topLeft.green;
+            blue += bottomRight.blue - topRight.blue - bottomLeft.blue + topLeft.blue;
+        }
+    }
+
+    if (alpha == 0) {
+        return kpColor::Transparent;
+    }
+
+    const quint64 count = quint64 (clippedRect.width ()) * clippedRect.height ();
+
+    // Unpremultiply the sums, rounding to nearest.
+    const auto unpremultiplied = [alpha] (quint64 sum) {
+        return int (qMin <quint64> (255, (sum * 255 + alpha / 2) / alpha));
+    };
+
+    return kpColor (qRgba (unpremultiplied (red),
+                           unpremultiplied (green),
+                           unpremultiplied (blue),
+                           int ((alpha + count / 2) / count)));
+}
+
+//---------------------------------------------------------------------
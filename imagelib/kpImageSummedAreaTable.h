@@ -0,0 +1,101 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+
+#ifndef KP_IMAGE_SUMMED_AREA_TABLE_H
+#define KP_IMAGE_SUMMED_AREA_TABLE_H
+
+
+#include <QHash>
+#include <QRect>
+#include <QVector>
+
+#include "imagelib/kpImage.h"
+
+
+class kpColor;
+
+
+//
+// Answers "what is the average color of this rectangle of the image?" in
+// constant time, for the color picker's averaging modes.
+//
+// The image is divided into the same grid of tiles as kpImageTileStore.
+// Each tile gets its own summed-area table, built the first time a
+// rectangle touching the tile is asked about.  A rectangle is then summed
+// with 4 lookups per tile it touches.
+//
+// The image itself is not stored (or copied), so it must be passed to
+// every call.  When its pixels change, call invalidate() so that only the
+// tables of the tiles that changed are rebuilt.
+//
+class kpImageSummedAreaTable
+{
+public:
+    kpImageSummedAreaTable ();
+
+
+    bool isEmpty () const;
+    void clear ();
+
+    // Forgets the tables of the tiles intersecting <rect>.
+    void invalidate (const QRect &rect);
+
+
+    // Returns the average color of the pixels of <image> in <rect>, after
+    // clipping it to the image.  The colors are weighted by their alpha, so
+    // that transparent pixels don't darken the result.
+    //
+    // Returns an invalid color if <rect> is completely outside the image.
+    kpColor averageColor (const kpImage &image, const QRect &rect);
+
+
+private:
+    // Premultiplied channel sums.
+    struct Sums
+    {
+        quint32 alpha, red, green, blue;
+    };
+
+    // (tileRect.width () + 1) x (tileRect.height () + 1) sums: the sum of
+    // the pixels above and to the left of each point of the tile.
+    typedef QVector <Sums> Table;
+
+    int tilesAcross () const;
+    QRect tileRect (int tileX, int tileY) const;
+
+    const Table &table (const kpImage &image, int tileX, int tileY);
+    static Table BuildTable (const kpImage &image, const QRect &tileRect);
+
+    QSize m_imageSize;
+    QHash <int, Table> m_tables;
+};
+
+
+#endif  // KP_IMAGE_SUMMED_AREA_TABLE_H
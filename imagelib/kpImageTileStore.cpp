@@ -0,0 +1,418 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#define DEBUG_KP_IMAGE_TILE_STORE 0
+
+
+#include "kpImageTileStore.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "kpLogCategories.h"
+
+#include "pixmapfx/kpPixmapFX.h"
+
+//---------------------------------------------------------------------
+
+// public static
+const int kpImageTileStore::TileSize = 64;
+
+//---------------------------------------------------------------------
+
+kpImageTileStore::kpImageTileStore (const QRect &imageRect)
+    : m_imageRect (imageRect)
+{
+    Q_ASSERT (m_imageRect.isNull () || m_imageRect.topLeft () == QPoint (0, 0));
+}
+
+//---------------------------------------------------------------------
+
+// public
+QRect kpImageTileStore::imageRect () const
+{
+    return m_imageRect;
+}
+
+//---------------------------------------------------------------------
+
+// public
+bool kpImageTileStore::isEmpty () const
+{
+    return m_tiles.isEmpty ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::clear ()
+{
+    m_tiles.clear ();
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpCommandSize::SizeType kpImageTileStore::size () const
+{
+    kpCommandSize::SizeType ret = 0;
+
+    for (const kpImage &tile : m_tiles) {
+        ret += kpCommandSize::ImageSize (tile);
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// private
+int kpImageTileStore::tilesAcross () const
+{
+    return (m_imageRect.width () + TileSize - 1) / TileSize;
+}
+
+//---------------------------------------------------------------------
+
+// private
+int kpImageTileStore::tilesDown () const
+{
+    return (m_imageRect.height () + TileSize - 1) / TileSize;
+}
+
+//---------------------------------------------------------------------
+
+// private
+int kpImageTileStore::tileIndex (int tileX, int tileY) const
+{
+    return tileY * tilesAcross () + tileX;
+}
+
+//---------------------------------------------------------------------
+
+// private
+QRect kpImageTileStore::tileRect (int index) const
+{
+    const int across = tilesAcross ();
+
+    return QRect ((index % across) * TileSize, (index / across) * TileSize,
+                  TileSize, TileSize)
+        .intersected (m_imageRect);
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::saveTiles (const kpImage &image, const QRect &rect)
+{
+    const QRect clippedRect = rect.intersected (m_imageRect);
+    if (clippedRect.isEmpty ()) {
+        return;
+    }
+
+    Q_ASSERT (image.rect () == m_imageRect);
+
+#if DEBUG_KP_IMAGE_TILE_STORE
+    qCDebug(kpLogImagelib) << "kpImageTileStore::saveTiles(" << rect << ")"
+                           << " numTiles=" << m_tiles.size ();
+#endif
+
+    for (int tileY = clippedRect.top () / TileSize;
+         tileY <= clippedRect.bottom () / TileSize;
+         tileY++)
+    {
+        for (int tileX = clippedRect.left () / TileSize;
+             tileX <= clippedRect.right () / TileSize;
+             tileX++)
+        {
+            const int index = tileIndex (tileX, tileY);
+            if (m_tiles.contains (index)) {
+                continue;
+            }
+
+            m_tiles.insert (index,
+                kpPixmapFX::getPixmapAt (image, tileRect (index)));
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private static
+bool kpImageTileStore::PixelsDiffer (const kpImage &image, const kpImage &newImage,
+        const QPoint &at, const QRect &rect)
+{
+    // (the shape functions draw with QPainter, which keeps the format)
+    if (image.format () != newImage.format () || image.depth () != 32) {
+        return true;
+    }
+
+    const int numBytes = rect.width () * 4;
+
+    for (int y = rect.top (); y <= rect.bottom (); y++)
+    {
+        const uchar *line = image.constScanLine (y) + rect.left () * 4;
+        const uchar *newLine = newImage.constScanLine (y - at.y ()) +
+            (rect.left () - at.x ()) * 4;
+
+        if (memcmp (line, newLine, numBytes) != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::saveChangedTiles (const kpImage &image,
+        const kpImage &newImage, const QPoint &at)
+{
+    const QRect clippedRect =
+        QRect (at, newImage.size ()).intersected (m_imageRect);
+    if (clippedRect.isEmpty ()) {
+        return;
+    }
+
+    Q_ASSERT (image.rect () == m_imageRect);
+
+    for (int tileY = clippedRect.top () / TileSize;
+         tileY <= clippedRect.bottom () / TileSize;
+         tileY++)
+    {
+        for (int tileX = clippedRect.left () / TileSize;
+             tileX <= clippedRect.right () / TileSize;
+             tileX++)
+        {
+            const int index = tileIndex (tileX, tileY);
+            if (m_tiles.contains (index)) {
+                continue;
+            }
+
+            const QRect rect = tileRect (index);
+            if (!PixelsDiffer (image, newImage, at, rect.intersected (clippedRect))) {
+                continue;
+            }
+
+            m_tiles.insert (index, kpPixmapFX::getPixmapAt (image, rect));
+        }
+    }
+
+#if DEBUG_KP_IMAGE_TILE_STORE
+    qCDebug(kpLogImagelib) << "kpImageTileStore::saveChangedTiles(" << at << ")"
+                           << " numTiles=" << m_tiles.size ();
+#endif
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::removeTilesOutside (const QRect &rect)
+{
+    for (auto it = m_tiles.begin (); it != m_tiles.end (); )
+    {
+        if (!tileRect (it.key ()).intersects (rect)) {
+            it = m_tiles.erase (it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::removeTilesOutside (const TileMask &mask)
+{
+    Q_ASSERT (mask.size () == tilesAcross () * tilesDown ());
+
+    for (auto it = m_tiles.begin (); it != m_tiles.end (); )
+    {
+        if (!mask.testBit (it.key ())) {
+            it = m_tiles.erase (it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::merge (const kpImageTileStore &later)
+{
+    Q_ASSERT (later.m_imageRect == m_imageRect);
+
+    for (auto it = later.m_tiles.constBegin (); it != later.m_tiles.constEnd (); ++it)
+    {
+        if (!m_tiles.contains (it.key ())) {
+            m_tiles.insert (it.key (), it.value ());
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+QList <QRect> kpImageTileStore::tileRects () const
+{
+    QList <QRect> ret;
+
+    for (auto it = m_tiles.constBegin (); it != m_tiles.constEnd (); ++it) {
+        ret.append (tileRect (it.key ()));
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QRect kpImageTileStore::boundingRect () const
+{
+    QRect ret;
+
+    for (auto it = m_tiles.constBegin (); it != m_tiles.constEnd (); ++it) {
+        ret = ret.united (tileRect (it.key ()));
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+QRegion kpImageTileStore::region () const
+{
+    QList <int> indexes = m_tiles.keys ();
+    std::sort (indexes.begin (), indexes.end ());
+
+    QRegion ret;
+
+    // Add runs of tiles along each row as one rectangle.
+    QRect run;
+    for (const int index : indexes)
+    {
+        const QRect rect = tileRect (index);
+
+        if (run.isValid () && rect.top () == run.top () &&
+            rect.left () == run.right () + 1)
+        {
+            run.setRight (rect.right ());
+        }
+        else
+        {
+            ret += run;
+            run = rect;
+        }
+    }
+    ret += run;
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+kpImageTileStore::TileMask kpImageTileStore::tileMask () const
+{
+    return TileMask (tilesAcross () * tilesDown ());
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::addToTileMask (TileMask *mask, const QRect &rect) const
+{
+    Q_ASSERT (mask && mask->size () == tilesAcross () * tilesDown ());
+
+    const QRect clippedRect = rect.intersected (m_imageRect);
+    if (clippedRect.isEmpty ()) {
+        return;
+    }
+
+    for (int tileY = clippedRect.top () / TileSize;
+         tileY <= clippedRect.bottom () / TileSize;
+         tileY++)
+    {
+        for (int tileX = clippedRect.left () / TileSize;
+             tileX <= clippedRect.right () / TileSize;
+             tileX++)
+        {
+            mask->setBit (tileIndex (tileX, tileY));
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+QList <kpImage *> kpImageTileStore::tileImages ()
+{
+    QList <kpImage *> ret;
+
+    for (auto it = m_tiles.begin (); it != m_tiles.end (); ++it) {
+        ret.append (&it.value ());
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::restore (kpImage *image) const
+{
+    Q_ASSERT (image && image->rect () == m_imageRect);
+
+    for (auto it = m_tiles.constBegin (); it != m_tiles.constEnd (); ++it) {
+        kpPixmapFX::setPixmapAt (image, tileRect (it.key ()).topLeft (), it.value ());
+    }
+}
+
+//---------------------------------------------------------------------
+
+// public
+void kpImageTileStore::swap (kpImage *image)
+{
+    Q_ASSERT (image && image->rect () == m_imageRect);
+
+    for (auto it = m_tiles.begin (); it != m_tiles.end (); ++it)
+    {
+        const QRect rect = tileRect (it.key ());
+
+        const kpImage oldTile = kpPixmapFX::getPixmapAt (*image, rect);
+        kpPixmapFX::setPixmapAt (image, rect.topLeft (), it.value ());
+        it.value () = oldTile;
+    }
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,149 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef KP_IMAGE_TILE_STORE_H
+#define KP_IMAGE_TILE_STORE_H
+
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QRect>
+#include <QRegion>
+
+#include "imagelib/kpImage.h"
+#include "commands/kpCommandSize.h"
+
+
+//
+// Stores copies of some of the tiles of an image.
+//
+// The image is divided into a grid of TileSize x TileSize tiles, starting
+// at (0,0).  Tiles on the right and bottom edges are clipped to the
+// image.  A tile is copied out of the image the first time it is asked
+// for by saveTiles() and never again, so that the store ends up holding
+// the contents the tiles had before they were first modified.
+//
+// This lets commands record undo data for only the part of the document
+// that they touch, without copying (or holding a shared copy of) the
+// whole document.
+//
+class kpImageTileStore
+{
+public:
+    static const int TileSize;
+
+    // A set of tiles of the grid, as a bitmap with one bit per tile.
+    // See tileMask().
+    typedef QBitArray TileMask;
+
+    // Constructs an empty store for an image with the given rectangle.
+    // The rectangle must have its top-left at (0,0).
+    kpImageTileStore (const QRect &imageRect = QRect ());
+
+
+    QRect imageRect () const;
+
+    bool isEmpty () const;
+    void clear ();
+
+    // Returns the sum of the sizes of the stored tiles.
+    kpCommandSize::SizeType size () const;
+
+
+    // Copies out of <image>, the tiles intersecting <rect> that have not
+    // been saved yet.
+    void saveTiles (const kpImage &image, const QRect &rect);
+
+    // Copies out of <image>, the tiles that have not been saved yet and
+    // that would change if <newImage> were set at <at> in <image>.
+    //
+    // Use this, before setting <newImage>, to save just the tiles that a
+    // shape really covers rather than its whole bounding rectangle.
+    void saveChangedTiles (const kpImage &image,
+        const kpImage &newImage, const QPoint &at);
+
+    // Forgets the tiles that don't intersect <rect>.
+    void removeTilesOutside (const QRect &rect);
+
+    // Forgets the tiles that are not in <mask>.
+    void removeTilesOutside (const TileMask &mask);
+
+    // Takes the tiles of <later>, which must have been saved from the same
+    // image after this store's, that this store doesn't have yet.  The
+    // tiles that both stores have are kept from this store, as they are
+    // older.  So this store ends up holding the contents from before both
+    // stores' modifications.
+    void merge (const kpImageTileStore &later);
+
+
+    // Returns the (clipped) rectangles of the stored tiles.
+    QList <QRect> tileRects () const;
+
+    // Returns the union of tileRects().
+    QRect boundingRect () const;
+
+    // Returns the exact area covered by tileRects().
+    QRegion region () const;
+
+
+    // Returns an empty set of the tiles of this store's image.
+    TileMask tileMask () const;
+
+    // Adds the tiles intersecting <rect> to <mask>, which must have come
+    // from tileMask().
+    void addToTileMask (TileMask *mask, const QRect &rect) const;
+
+    // Returns pointers to the stored tiles, in the same order as
+    // tileRects().  They remain valid until the store is next modified.
+    QList <kpImage *> tileImages ();
+
+
+    // Writes the stored tiles back into <image>.
+    void restore (kpImage *image) const;
+
+    // Exchanges the stored tiles with the corresponding parts of <image>.
+    // Calling this twice is a NOP.
+    void swap (kpImage *image);
+
+
+private:
+    int tilesAcross () const;
+    int tilesDown () const;
+    int tileIndex (int tileX, int tileY) const;
+    QRect tileRect (int index) const;
+
+    static bool PixelsDiffer (const kpImage &image, const kpImage &newImage,
+        const QPoint &at, const QRect &rect);
+
+    QRect m_imageRect;
+    QHash <int, kpImage> m_tiles;
+};
+
+
+#endif  // KP_IMAGE_TILE_STORE_H
@@ -0,0 +1,189 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef kpLineIterator_H
+#define kpLineIterator_H
+
+
+#include <QPoint>
+#include <QtGlobal>
+
+#include "imagelib/kpStrokeRandom.h"
+
+
+//
+// Steps through the points of the line from <startPoint> to <endPoint>
+// (inclusive), one at a time, without allocating.  Use it like:
+//
+//     for (kpLineIterator <> it (startPoint, endPoint); !it.atEnd (); it.next ())
+//         plot (it.point ());
+//
+// If <CardinalAdjacency>, every point is horizontally or vertically
+// adjacent to the previous one (if there is more than 1 point, of course).
+// This is in contrast to the ordinary line algorithm which can create
+// diagonal adjacencies.
+//
+// If <WithProbability>, each point is only visited with the probability
+// given to the constructor, decided using the given per-stroke random
+// number generator.
+//
+// The points visited are the same as those of kpPainter::interpolatePoints(),
+// which is implemented using this.
+//
+template <bool CardinalAdjacency = false, bool WithProbability = false>
+class kpLineIterator
+{
+public:
+    kpLineIterator (const QPoint &startPoint, const QPoint &endPoint)
+        : kpLineIterator (startPoint, endPoint, 1000, nullptr)
+    {
+        static_assert (!WithProbability, "Pass a probability and a kpStrokeRandom");
+    }
+
+    // <probabilityTimes1000> is in [0, 1000].
+    kpLineIterator (const QPoint &startPoint, const QPoint &endPoint,
+            int probabilityTimes1000, kpStrokeRandom *random)
+        : m_ix (qAbs (endPoint.x () - startPoint.x ())),
+          m_iy (qAbs (endPoint.y () - startPoint.y ())),
+          // Larger of the x and y differences
+          m_inc (qMax (m_ix, m_iy)),
+          m_stepX (endPoint.x () < startPoint.x () ? -1 : +1),
+          m_stepY (endPoint.y () < startPoint.y () ? -1 : +1),
+          m_plot (startPoint),
+          m_point (startPoint),
+          m_x (0), m_y (0),
+          m_i (0),
+          m_hasPendingPlot (false),
+          m_atEnd (false),
+          m_probabilityTimes1000 (probabilityTimes1000),
+          m_random (random)
+    {
+        Q_ASSERT (!WithProbability ||
+                  (m_random &&
+                   m_probabilityTimes1000 >= 0 && m_probabilityTimes1000 <= 1000));
+
+        skipUnselected ();
+    }
+
+    bool atEnd () const { return m_atEnd; }
+
+    const QPoint &point () const { return m_point; }
+
+    void next ()
+    {
+        step ();
+        skipUnselected ();
+    }
+
+private:
+    // Derived from the zSprite2 Graphics Engine via
+    // kpPainter::interpolatePoints().
+    void step ()
+    {
+        if (m_hasPendingPlot)
+        {
+            m_hasPendingPlot = false;
+            m_point = m_plot;
+            return;
+        }
+
+        while (m_i <= m_inc)
+        {
+            m_i++;
+
+            // oldPlotX is equally as valid but would look different
+            // (but nobody will notice which one it is)
+            const int oldPlotY = m_plot.y ();
+            int plot = 0;
+
+            m_x += m_ix;
+            m_y += m_iy;
+
+            if (m_x > m_inc)
+            {
+                plot++;
+                m_x -= m_inc;
+                m_plot.rx () += m_stepX;
+            }
+
+            if (m_y > m_inc)
+            {
+                plot++;
+                m_y -= m_inc;
+                m_plot.ry () += m_stepY;
+            }
+
+            if (plot)
+            {
+                if (CardinalAdjacency && plot == 2)
+                {
+                    m_point = QPoint (m_plot.x (), oldPlotY);
+                    m_hasPendingPlot = true;
+                }
+                else
+                {
+                    m_point = m_plot;
+                }
+
+                return;
+            }
+        }
+
+        m_atEnd = true;
+    }
+
+    void skipUnselected ()
+    {
+        if (!WithProbability || m_probabilityTimes1000 >= 1000) {
+            return;
+        }
+
+        while (!m_atEnd &&
+               static_cast <int> (m_random->bounded (1000)) >= m_probabilityTimes1000)
+        {
+            step ();
+        }
+    }
+
+    const int m_ix, m_iy;
+    const int m_inc;
+    const int m_stepX, m_stepY;
+
+    QPoint m_plot;
+    QPoint m_point;
+    int m_x, m_y;
+    int m_i;
+    bool m_hasPendingPlot;
+    bool m_atEnd;
+
+    const int m_probabilityTimes1000;
+    kpStrokeRandom * const m_random;
+};
+
+
+#endif  // kpLineIterator_H
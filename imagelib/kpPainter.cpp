@@ -31,15 +31,21 @@
 
 #include "kpPainter.h"
 
+#include "imagelib/kpLineIterator.h"
+
 #include "pixmapfx/kpPixmapFX.h"
 #include "tools/kpTool.h"
 #include "tools/flow/kpToolFlowBase.h"
 
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 
+#include <QHash>
 #include <QPainter>
 #include <QPolygon>
 #include <QRandomGenerator>
+#include <QVector>
 
 #include "kpLogCategories.h"
 
@@ -56,6 +62,14 @@ bool kpPainter::pointsAreCardinallyAdjacent (const QPoint &p, const QPoint &q)
 
 //---------------------------------------------------------------------
 
+template <typename LineIterator>
+static void appendLinePoints (QList <QPoint> *points, LineIterator it)
+{
+    for (; !it.atEnd (); it.next ()) {
+        points->append (it.point ());
+    }
+}
+
 // public static
 QList <QPoint> kpPainter::interpolatePoints (const QPoint &startPoint,
     const QPoint &endPoint,
@@ -71,100 +85,30 @@ QList <QPoint> kpPainter::interpolatePoints (const QPoint &startPoint,
 
     Q_ASSERT (probability >= 0.0 && probability <= 1.0);
     const int probabilityTimes1000 = qRound (probability * 1000);
-#define SHOULD_DRAW()  ( (probabilityTimes1000 == 1000) /*avoid QRandomGenerator call*/ ||  \
-                         (QRandomGenerator::global()->bounded(1000) < probabilityTimes1000) )
-
-
-    // Derived from the zSprite2 Graphics Engine.
-    // "MODIFIED" comment shows deviation from zSprite2 and Bresenham's line
-    // algorithm.
-
-    const int x1 = startPoint.x (),
-        y1 = startPoint.y (),
-        x2 = endPoint.x (),
-        y2 = endPoint.y ();
-
-    // Difference of x and y values
-    const int dx = x2 - x1;
-    const int dy = y2 - y1;
-
-    // Absolute values of differences
-    const int ix = qAbs (dx);
-    const int iy = qAbs (dy);
-
-    // Larger of the x and y differences
-    const int inc = ix > iy ? ix : iy;
-
-    // Plot location
-    int plotx = x1;
-    int ploty = y1;
-
-    int x = 0;
-    int y = 0;
 
-    if (SHOULD_DRAW ()) {
-        ret.append (QPoint (plotx, ploty));
-    }
-
-
-    for (int i = 0; i <= inc; i++)
+    if (probabilityTimes1000 == 1000)
     {
-        // oldplotx is equally as valid but would look different
-        // (but nobody will notice which one it is)
-        const int oldploty = ploty;
-        int plot = 0;
-
-        x += ix;
-        y += iy;
-
-        if (x > inc)
-        {
-            plot++;
-            x -= inc;
-
-            if (dx < 0) {
-                plotx--;
-            }
-            else {
-                plotx++;
-            }
+        if (cardinalAdjacency) {
+            appendLinePoints (&ret, kpLineIterator <true> (startPoint, endPoint));
         }
-
-        if (y > inc)
-        {
-            plot++;
-            y -= inc;
-
-            if (dy < 0) {
-                ploty--;
-            }
-            else {
-                ploty++;
-            }
+        else {
+            appendLinePoints (&ret, kpLineIterator <false> (startPoint, endPoint));
         }
+    }
+    else
+    {
+        kpStrokeRandom random (QRandomGenerator::global ()->generate ());
 
-        if (plot)
-        {
-            if (cardinalAdjacency && plot == 2)
-            {
-                // MODIFIED: Every point is
-                // horizontally or vertically adjacent to another point (if there
-                // is more than 1 point, of course).  This is in contrast to the
-                // ordinary line algorithm which can create diagonal adjacencies.
-
-                if (SHOULD_DRAW ()) {
-                    ret.append (QPoint (plotx, oldploty));
-                }
-            }
-
-            if (SHOULD_DRAW ()) {
-                ret.append (QPoint (plotx, ploty));
-            }
+        if (cardinalAdjacency) {
+            appendLinePoints (&ret, kpLineIterator <true, true> (startPoint, endPoint,
+                probabilityTimes1000, &random));
+        }
+        else {
+            appendLinePoints (&ret, kpLineIterator <false, true> (startPoint, endPoint,
+                probabilityTimes1000, &random));
         }
     }
 
-#undef SHOULD_DRAW
-
     return ret;
 }
 
@@ -352,21 +296,18 @@ static QRect WashLineHelper (QPainter *rgbPainter, void *data)
 
     bool didSomething = false;
 
-    QList <QPoint> points = kpPainter::interpolatePoints (pack->startPoint, pack->endPoint);
-    foreach (const QPoint &p, points)
+    for (kpLineIterator <> it (pack->startPoint, pack->endPoint); !it.atEnd (); it.next ())
     {
         // OPT: This may be reading and possibly writing pixels that were
         //      visited on a previous iteration, since the pen is usually
-        //      bigger than 1 pixel.  Maybe we could use QRegion to determine
-        //      all the non-intersecting regions and only wash each region once.
-        //
-        //      Profiling needs to be done as QRegion is known to be a CPU hog.
+        //      bigger than 1 pixel.  WashRuns(), below, only washes each
+        //      pixel once but only handles images in the usual formats.
         if (::ReadableImageWashRect (rgbPainter,
                 pack->readableImage,
                 pack->colorToReplace,
                 pack->readableImageRect,
                 kpToolFlowBase::hotRectForMousePointAndBrushWidthHeight (
-                    p, pack->penWidth, pack->penHeight),
+                    it.point (), pack->penWidth, pack->penHeight),
                 pack->processedColorSimilarity))
         {
             didSomething = true;
@@ -391,6 +332,230 @@ static QRect WashLineHelper (QPainter *rgbPainter, void *data)
 
 //---------------------------------------------------------------------
 
+// Returns whether WashRuns() can wash <image> with <color>.
+//
+// The painter-based washing above draws with the default composition mode,
+// so a transparent <color> leaves the pixels unchanged.  Only opaque colors,
+// which are the same premultiplied or not, are written directly.
+static bool CanWashDirectly (const QImage &image, const kpColor &color,
+        const kpColor &colorToReplace)
+{
+    return (color.isValid () && color.alpha () == 255 &&
+            colorToReplace.isValid () &&
+            (image.format () == QImage::Format_ARGB32_Premultiplied ||
+             image.format () == QImage::Format_ARGB32 ||
+             image.format () == QImage::Format_RGB32));
+}
+
+//---------------------------------------------------------------------
+
+// Batch similarity kernel: replaces each of the <count> <pixels> that is
+// similar to <colorToReplace> (as per kpColor::isSimilarTo()) with
+// <replacement>.
+//
+// Pixels that already are <replacement> are not counted as changes.
+// Returns the index of the first changed pixel and sets <lastChanged> to
+// the index of the last one, or returns -1 if nothing changed.
+static int WashSpan (QRgb *pixels, int count, bool premultiplied,
+        QRgb colorToReplace, int processedColorSimilarity,
+        QRgb replacement,
+        int *lastChanged)
+{
+    const int red = qRed (colorToReplace),
+              green = qGreen (colorToReplace),
+              blue = qBlue (colorToReplace);
+
+    int firstChanged = -1;
+
+    for (int i = 0; i < count; i++)
+    {
+        QRgb rgba = pixels [i];
+        if (rgba == replacement) {
+            continue;
+        }
+
+        // (kpPixmapFX::getColorAtPixel() compares unpremultiplied colors)
+        if (premultiplied && qAlpha (rgba) != 255) {
+            rgba = qUnpremultiply (rgba);
+        }
+
+        const bool isSimilar =
+            (rgba == colorToReplace) ||
+            (processedColorSimilarity != kpColor::Exact &&
+                (red - qRed (rgba)) * (red - qRed (rgba)) +
+                (green - qGreen (rgba)) * (green - qGreen (rgba)) +
+                (blue - qBlue (rgba)) * (blue - qBlue (rgba))
+                    <= processedColorSimilarity);
+        if (!isSimilar) {
+            continue;
+        }
+
+        pixels [i] = replacement;
+
+        if (firstChanged < 0) {
+            firstChanged = i;
+        }
+        *lastChanged = i;
+    }
+
+    return firstChanged;
+}
+
+//---------------------------------------------------------------------
+
+// A run of pixels to wash, on row <y> from column <left> to <right>
+// inclusive.
+struct WashRun
+{
+    int y, left, right;
+};
+
+//---------------------------------------------------------------------
+
+// Washes, on <image>, the pixels of each of <runs>.  No two runs may
+// overlap, so each pixel is visited once.
+//
+// ASSUMPTION: CanWashDirectly (*image, color, colorToReplace).
+// Returns the bounds of the pixels that changed.
+static QRect WashRuns (kpImage *image,
+        const QVector <WashRun> &runs,
+        const kpColor &color,
+        const kpColor &colorToReplace,
+        int processedColorSimilarity)
+{
+    Q_ASSERT (::CanWashDirectly (*image, color, colorToReplace));
+
+    const bool premultiplied =
+        (image->format () == QImage::Format_ARGB32_Premultiplied);
+    const QRgb replacement = color.toQRgb ();
+    const QRgb rgbaToReplace = colorToReplace.toQRgb ();
+
+    int minX = image->width (), minY = image->height (), maxX = -1, maxY = -1;
+
+    for (const auto &run : runs)
+    {
+        const int y = run.y;
+        if (y < 0 || y >= image->height ()) {
+            continue;
+        }
+
+        const int left = qMax (run.left, 0),
+                  right = qMin (run.right, image->width () - 1);
+        if (left > right) {
+            continue;
+        }
+
+        auto *pixels = reinterpret_cast <QRgb *> (image->scanLine (y)) + left;
+
+        int lastChanged = -1;
+        const int firstChanged = ::WashSpan (pixels, right - left + 1,
+            premultiplied,
+            rgbaToReplace, processedColorSimilarity,
+            replacement,
+            &lastChanged);
+        if (firstChanged < 0) {
+            continue;
+        }
+
+        minX = qMin (minX, left + firstChanged);
+        maxX = qMax (maxX, left + lastChanged);
+        minY = qMin (minY, y);
+        maxY = qMax (maxY, y);
+    }
+
+    if (maxX < 0) {
+        return {};
+    }
+
+    return QRect (QPoint (minX, minY), QPoint (maxX, maxY));
+}
+
+//---------------------------------------------------------------------
+
+// Appends to <runs>, as runs for WashRuns(), the union of the pen
+// rectangles of <penWidth>x<penHeight> centred at each point of the line
+// from <startPoint> to <endPoint>.
+//
+// Since the points of the line are adjacent and sorted in both x and y,
+// the pens covering any one row form a single run.
+static void LineCoverageRuns (const QPoint &startPoint, const QPoint &endPoint,
+        int penWidth, int penHeight,
+        QVector <WashRun> *runs)
+{
+    const QRect bounds = kpTool::neededRect (
+        kpPainter::normalizedRect (startPoint, endPoint),
+        qMax (penWidth, penHeight));
+
+    const int firstRow = bounds.top ();
+    QVector <int> runLeft (bounds.height (), INT_MAX),
+                  runRight (bounds.height (), INT_MIN);
+
+    for (kpLineIterator <> it (startPoint, endPoint); !it.atEnd (); it.next ())
+    {
+        const QRect pen = kpToolFlowBase::hotRectForMousePointAndBrushWidthHeight (
+            it.point (), penWidth, penHeight);
+
+        for (int y = pen.top (); y <= pen.bottom (); y++)
+        {
+            const int i = y - firstRow;
+
+            runLeft [i] = qMin (runLeft [i], pen.left ());
+            runRight [i] = qMax (runRight [i], pen.right ());
+        }
+    }
+
+    for (int i = 0; i < bounds.height (); i++)
+    {
+        if (runLeft [i] <= runRight [i]) {
+            runs->append (WashRun {firstRow + i, runLeft [i], runRight [i]});
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Returns, as runs for WashRuns(), the union of the pen rectangles of
+// <penWidth>x<penHeight> centred at each point of the polyline through
+// <points>.
+//
+// A polyline can cross a row several times, so the runs of its lines are
+// sorted and the ones that touch are merged.
+static QVector <WashRun> PolylineCoverageRuns (const QPolygon &points,
+        int penWidth, int penHeight)
+{
+    QVector <WashRun> runs;
+    for (int i = 1; i < points.count (); i++)
+    {
+        ::LineCoverageRuns (points [i - 1], points [i], penWidth, penHeight,
+            &runs);
+    }
+
+    std::sort (runs.begin (), runs.end (),
+        [] (const WashRun &a, const WashRun &b) {
+            return (a.y != b.y) ? (a.y < b.y) : (a.left < b.left);
+        });
+
+    QVector <WashRun> mergedRuns;
+    mergedRuns.reserve (runs.size ());
+    for (const auto &run : qAsConst (runs))
+    {
+        if (!mergedRuns.isEmpty () &&
+            mergedRuns.last ().y == run.y &&
+            mergedRuns.last ().right >= run.left - 1)
+        {
+            mergedRuns.last ().right = qMax (mergedRuns.last ().right, run.right);
+        }
+        else
+        {
+            mergedRuns.append (run);
+        }
+    }
+
+    return mergedRuns;
+}
+
+//---------------------------------------------------------------------
+
 // public static
 QRect kpPainter::washLine (kpImage *image,
         int x1, int y1, int x2, int y2,
@@ -398,6 +563,17 @@ QRect kpPainter::washLine (kpImage *image,
         const kpColor &colorToReplace,
         int processedColorSimilarity)
 {
+    if (::CanWashDirectly (*image, color, colorToReplace))
+    {
+        QVector <WashRun> runs;
+        ::LineCoverageRuns (QPoint (x1, y1), QPoint (x2, y2),
+            penWidth, penHeight,
+            &runs);
+
+        return ::WashRuns (image, runs,
+            color, colorToReplace, processedColorSimilarity);
+    }
+
     return ::Wash (image,
         QPoint (x1, y1), QPoint (x2, y2),
         color, penWidth, penHeight,
@@ -408,6 +584,43 @@ QRect kpPainter::washLine (kpImage *image,
 
 //---------------------------------------------------------------------
 
+// public static
+QRect kpPainter::washPolyline (kpImage *image,
+        const QPolygon &points,
+        const kpColor &color, int penWidth, int penHeight,
+        const kpColor &colorToReplace,
+        int processedColorSimilarity)
+{
+    if (points.count () == 1)
+    {
+        return kpPainter::washLine (image,
+            points [0].x (), points [0].y (), points [0].x (), points [0].y (),
+            color, penWidth, penHeight,
+            colorToReplace, processedColorSimilarity);
+    }
+
+    if (::CanWashDirectly (*image, color, colorToReplace))
+    {
+        return ::WashRuns (image,
+            ::PolylineCoverageRuns (points, penWidth, penHeight),
+            color, colorToReplace, processedColorSimilarity);
+    }
+
+    QRect dirtyRect;
+    for (int i = 1; i < points.count (); i++)
+    {
+        dirtyRect |= kpPainter::washLine (image,
+            points [i - 1].x (), points [i - 1].y (),
+            points [i].x (), points [i].y (),
+            color, penWidth, penHeight,
+            colorToReplace, processedColorSimilarity);
+    }
+
+    return dirtyRect;
+}
+
+//---------------------------------------------------------------------
+
 static QRect WashRectHelper (QPainter *rgbPainter, void *data)
 {
     auto *pack = static_cast <WashPack *> (data);
@@ -459,6 +672,18 @@ QRect kpPainter::washRect (kpImage *image,
         const kpColor &colorToReplace,
         int processedColorSimilarity)
 {
+    if (::CanWashDirectly (*image, color, colorToReplace))
+    {
+        QVector <WashRun> runs;
+        runs.reserve (height);
+        for (int row = y; row < y + height; row++) {
+            runs.append (WashRun {row, x, x + width - 1});
+        }
+
+        return ::WashRuns (image, runs,
+            color, colorToReplace, processedColorSimilarity);
+    }
+
     return ::Wash (image,
         QPoint (x, y), QPoint (x + width - 1, y + height - 1),
         color, 1/*pen width*/, 1/*pen height*/,
@@ -469,44 +694,143 @@ QRect kpPainter::washRect (kpImage *image,
 
 //---------------------------------------------------------------------
 
+// Returns the offsets, from the centre, of all the pixels that a spray of
+// <spraycanSize> can land on.
+//
+// The tables are built once per size and kept, as the spraycan asks for
+// one on every mouse move and timer tick.
+static const QVector <QPoint> &SprayOffsets (int spraycanSize)
+{
+    static QHash <int, QVector <QPoint>> offsetsForSize;
+
+    auto it = offsetsForSize.find (spraycanSize);
+    if (it != offsetsForSize.end ()) {
+        return *it;
+    }
+
+    const int radius = spraycanSize / 2;
+
+    QVector <QPoint> offsets;
+    offsets.reserve (spraycanSize * spraycanSize);
+
+    for (int dy = -radius; dy < spraycanSize - radius; dy++)
+    {
+        for (int dx = -radius; dx < spraycanSize - radius; dx++)
+        {
+            // Make it look circular.
+            if ((dx * dx) + (dy * dy) <= (radius * radius)) {
+                offsets.append (QPoint (dx, dy));
+            }
+        }
+    }
+
+    return *offsetsForSize.insert (spraycanSize, offsets);
+}
+
 // public static
-void kpPainter::sprayPoints (kpImage *image,
+QRect kpPainter::sprayPoints (kpImage *image,
         const QList <QPoint> &points,
         const kpColor &color,
-        int spraycanSize)
+        int spraycanSize,
+        kpStrokeRandom *random)
 {
 #if DEBUG_KP_PAINTER
     qCDebug(kpLogImagelib) << "kpPainter::sprayPoints()";
 #endif
 
     Q_ASSERT (spraycanSize > 0);
+    Q_ASSERT (random);
 
-    QPainter painter(image);
-    const int radius = spraycanSize / 2;
+    // About as dense as the 10 tries per point, ~pi/4 of which used to land
+    // inside the circle.
+    const int DotsPerPoint = 8;
 
-    // Set the drawing colors for the painters.
+    // (the painter below would draw a transparent dot over the existing
+    //  pixel, which leaves it unchanged)
+    if (points.isEmpty () || color.isTransparent ()) {
+        return {};
+    }
 
-    painter.setPen(color.toQColor());
+    // Picking one of these is the same as picking a pixel in the circle,
+    // uniformly, without having to throw away any that miss.
+    const QVector <QPoint> &offsets = ::SprayOffsets (spraycanSize);
+    const quint32 numOffsets = static_cast <quint32> (offsets.size ());
 
-    for (const auto &p : points)
+    const int width = image->width (), height = image->height ();
+
+    int minX = width, minY = height, maxX = -1, maxY = -1;
+
+    if (color.alpha () == 255 &&
+        (image->format () == QImage::Format_ARGB32_Premultiplied ||
+         image->format () == QImage::Format_ARGB32 ||
+         image->format () == QImage::Format_RGB32))
     {
-        for (int i = 0; i < 10; i++)
+        // An opaque color is the same premultiplied or not, so the dots
+        // can be written straight into the scanlines.
+        const QRgb pixel = color.toQRgb ();
+
+        uchar * const bits = image->bits ();
+        const int bytesPerLine = image->bytesPerLine ();
+
+        for (const auto &p : points)
         {
-            const int dx = (QRandomGenerator::global()->generate() % spraycanSize) - radius;
-            const int dy = (QRandomGenerator::global()->generate() % spraycanSize) - radius;
+            for (int i = 0; i < DotsPerPoint; i++)
+            {
+                const QPoint &offset = offsets [random->bounded (numOffsets)];
+                const int x = p.x () + offset.x (), y = p.y () + offset.y ();
 
-            // Make it look circular.
-            // TODO: Can be done better by doing a random vector angle & length
-            //       but would sin and cos be too slow?
-            if ((dx * dx) + (dy * dy) > (radius * radius)) {
-                continue;
+                if (x < 0 || y < 0 || x >= width || y >= height) {
+                    continue;
+                }
+
+                reinterpret_cast <QRgb *> (bits + y * bytesPerLine) [x] = pixel;
+
+                minX = qMin (minX, x);
+                minY = qMin (minY, y);
+                maxX = qMax (maxX, x);
+                maxY = qMax (maxY, y);
             }
+        }
+    }
+    else
+    {
+        QPolygon dots;
+        dots.reserve (points.size () * DotsPerPoint);
 
-            const QPoint p2 (p.x () + dx, p.y () + dy);
+        for (const auto &p : points)
+        {
+            for (int i = 0; i < DotsPerPoint; i++)
+            {
+                const QPoint dot = p + offsets [random->bounded (numOffsets)];
+
+                if (dot.x () < 0 || dot.y () < 0 ||
+                    dot.x () >= width || dot.y () >= height)
+                {
+                    continue;
+                }
+
+                dots.append (dot);
+
+                minX = qMin (minX, dot.x ());
+                minY = qMin (minY, dot.y ());
+                maxX = qMax (maxX, dot.x ());
+                maxY = qMax (maxY, dot.y ());
+            }
+        }
 
-            painter.drawPoint(p2);
+        if (!dots.isEmpty ())
+        {
+            QPainter painter (image);
+            painter.setPen (color.toQColor ());
+            painter.drawPoints (dots);
         }
     }
+
+    if (maxX < 0) {
+        return {};
+    }
+
+    return QRect (QPoint (minX, minY), QPoint (maxX, maxY));
 }
 
 //---------------------------------------------------------------------
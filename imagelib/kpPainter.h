@@ -49,6 +49,10 @@
 // the image library.  Currently uses QPainter/kpPixmapFX as the image library.
 //
 
+class QPolygon;
+
+class kpStrokeRandom;
+
 struct kpPainterPrivate;
 
 class kpPainter
@@ -92,6 +96,9 @@ public:
     // a point at 'c'.
     //
     // ASSUMPTION: <probability> is between 0.0 and 1.0 inclusive.
+    //
+    // Code that draws on every mouse move should step through the points
+    // with kpLineIterator instead, which does not build a list.
     static QList <QPoint> interpolatePoints (const QPoint &startPoint,
         const QPoint &endPoint,
         bool cardinalAdjacency = false,
@@ -116,21 +123,36 @@ public:
         const kpColor &colorToReplace,
         int processedColorSimilarity);
 
+    // Same as calling washLine() for each line of the polyline through
+    // <points>, except that each pixel is only visited once.
+    //
+    // Returns the dirty rectangle.
+    static QRect washPolyline (kpImage *image,
+        const QPolygon &points,
+        const kpColor &color, int penWidth, int penHeight,
+        const kpColor &colorToReplace,
+        int processedColorSimilarity);
+
     static QRect washRect (kpImage *image,
         int x, int y, int width, int height,
         const kpColor &color,
         const kpColor &colorToReplace,
         int processedColorSimilarity);
 
-    // For each point in <points>, sprays a random pattern of 10 dots of <color>,
+    // For each point in <points>, sprays a random pattern of 8 dots of <color>,
     // each within a circle of diameter <spraycanSize>, onto <image>.
+    // The dots are picked uniformly from the pixels of the circle, using
+    // <random>.
+    //
+    // Returns the dirty rectangle (the bounds of the dots actually drawn).
     //
     // ASSUMPTION: spraycanSize > 0.
     // TODO: I think this diameter is 1 or 2 off.
-    static void sprayPoints (kpImage *image,
+    static QRect sprayPoints (kpImage *image,
         const QList <QPoint> &points,
         const kpColor &color,
-        int spraycanSize);
+        int spraycanSize,
+        kpStrokeRandom *random);
 };
 
 
@@ -0,0 +1,79 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef kpStrokeRandom_H
+#define kpStrokeRandom_H
+
+
+#include <QtGlobal>
+
+
+//
+// Small, fast, unlocked pseudo-random number generator (xorshift32), for
+// the random effects of a single stroke (e.g. the Spraycan's dots).
+//
+// Unlike QRandomGenerator::global(), it is not thread-safe and its numbers
+// are nowhere near cryptographic quality - neither is needed to scatter
+// pixels.  Seed it once per stroke, from QRandomGenerator.
+//
+class kpStrokeRandom
+{
+public:
+    explicit kpStrokeRandom (quint32 seed = 1)
+    {
+        setSeed (seed);
+    }
+
+    void setSeed (quint32 seed)
+    {
+        // (xorshift gets stuck at 0)
+        m_state = seed ? seed : 0x9E3779B9u;
+    }
+
+    quint32 generate ()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    // Returns a number in [0, <highest>).
+    quint32 bounded (quint32 highest)
+    {
+        // (multiply-shift is cheaper than %, with negligible bias)
+        return static_cast <quint32> (
+            (static_cast <quint64> (generate ()) * highest) >> 32);
+    }
+
+private:
+    quint32 m_state;
+};
+
+
+#endif  // kpStrokeRandom_H
@@ -91,6 +91,12 @@
 #define kpSettingUndoMinLimit "Min Limit"
 #define kpSettingUndoMaxLimit "Max Limit"
 #define kpSettingUndoMaxLimitSizeLimit "Max Limit Size Limit"
+#define kpSettingUndoUncompressedLimit "Uncompressed Limit"
+#define kpSettingUndoSpillSizeLimit "Spill Size Limit"
+#define kpSettingUndoSpillDirectory "Spill Directory"
+#define kpSettingUndoCoalesceStrokesInterval "Coalesce Strokes Interval"
+#define kpSettingUndoGlobalSizeLimit "Global Size Limit"
+#define kpSettingUndoTimingsLimit "Timings Limit"
 
 
 #define kpSettingsGroupThumbnail "Thumbnail Settings"
@@ -1203,3 +1203,35 @@ void kpViewScrollableContainer::resizeEvent (QResizeEvent *e)
 
 //---------------------------------------------------------------------
 
+// protected virtual [base QAbstractScrollArea]
+void kpViewScrollableContainer::scrollContentsBy (int dx, int dy)
+{
+#if DEBUG_KP_VIEW_SCROLLABLE_CONTAINER && 1
+    qCDebug(kpLogMisc) << "kpViewScrollableContainer::scrollContentsBy("
+                       << dx << "," << dy << ")";
+#endif
+
+    // QScrollArea moves widget() to its new position, which repaints all
+    // of the view that is visible.  Instead, move the pixels that are
+    // already on the screen and let Qt send paint events for the newly
+    // exposed strips only.
+    //
+    // Everything the view draws (document, grid, selection resize handles,
+    // buddy rectangle) is in view coordinates and so moves along with the
+    // blitted pixels.  The overlay showing the document resize lines is
+    // positioned relative to the viewport instead, so don't blit while
+    // it's visible.
+    if (m_view && !m_overlay->isVisible () && !isRightToLeft () &&
+        (dx || dy))
+    {
+        viewport ()->scroll (dx, dy);
+    }
+
+    // Moves widget() to where it already is after the above, unless
+    // the alignment or the widget size disagree with our blit, in which
+    // case it corrects the position (and repaints).
+    QScrollArea::scrollContentsBy (dx, dy);
+}
+
+//---------------------------------------------------------------------
+
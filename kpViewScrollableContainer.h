@@ -183,6 +183,7 @@ private:
 
     void wheelEvent(QWheelEvent *e) override;
     void resizeEvent(QResizeEvent *e) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private slots:
     void slotGripBeganDraw ();
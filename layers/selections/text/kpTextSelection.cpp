@@ -79,6 +79,13 @@ kpTextSelection &kpTextSelection::operator= (const kpTextSelection &rhs)
     d->textStyle = rhs.d->textStyle;
     d->preeditText = rhs.d->preeditText;
 
+    // Don't copy the rendered image: copies are often kept by commands in
+    // the undo history, where it would hold memory that kpCommand::size()
+    // doesn't count.  The copy renders itself on its first paint().
+    d->renderedImage = kpImage ();
+    d->renderedTextLines.clear ();
+    d->changedPreeditRows.clear ();
+
     return *this;
 }
 
@@ -340,6 +347,15 @@ kpPreeditText kpTextSelection::preeditText () const
 
 void kpTextSelection::setPreeditText (const kpPreeditText &preeditText)
 {
+    // The preedit text is drawn into its row so paint() has to re-render
+    // the rows it leaves and enters.
+    if (!d->preeditText.isEmpty ()) {
+        d->changedPreeditRows.append (d->preeditText.position ().y ());
+    }
+    if (!preeditText.isEmpty ()) {
+        d->changedPreeditRows.append (preeditText.position ().y ());
+    }
+
     d->preeditText = preeditText;
     emit changed (boundingRect ());
 }
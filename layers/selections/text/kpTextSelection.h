@@ -35,6 +35,8 @@
 #include "layers/selections/text/kpTextStyle.h"
 #include "layers/selections/text/kpPreeditText.h"
 
+class QRegion;
+
 //
 // A rectangular text box containing lines of text, rendered in a given text
 // style.
@@ -265,6 +267,14 @@ public:
 private:
     void drawPreeditString(QPainter &painter, int &x, int y, const kpPreeditText &preeditText) const;
 
+    // Renders the part of the text box in <region> (relative to the top-left
+    // of the text box) into the cached image used by paint().
+    void renderText(const QRegion &region) const;
+
+    // Brings the cached image used by paint() up to date, re-rendering only
+    // the text lines that have changed since it was last rendered.
+    void updateRenderedImage() const;
+
 public:
     void paint(QImage *destPixmap, const QRect &docRect) const override;
 
@@ -31,6 +31,7 @@
 
 
 #include <QList>
+#include <QString>
 
 #include "imagelib/kpImage.h"
 #include "layers/selections/text/kpTextStyle.h"
@@ -41,6 +42,17 @@ struct kpTextSelectionPrivate
     QList <QString> textLines;
     kpTextStyle textStyle;
     kpPreeditText preeditText;
+
+    // The text box as last rendered by paint() (see
+    // kpTextSelection::updateRenderedImage()), and what it was rendered
+    // from.  A null <renderedImage> means nothing has been rendered yet.
+    kpImage renderedImage;
+    QList <QString> renderedTextLines;
+    kpTextStyle renderedTextStyle;
+
+    // The rows whose preedit text has changed since <renderedImage> was
+    // rendered.
+    QList <int> changedPreeditRows;
 };
 
 
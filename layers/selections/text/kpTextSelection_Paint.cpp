@@ -43,14 +43,19 @@
 
 #include <QBitmap>
 #include <QFont>
+#include <QFontMetrics>
 #include <QList>
 #include <QPainter>
+#include <QRegion>
 #include <QTextCharFormat>
 
 //---------------------------------------------------------------------
 
 void kpTextSelection::drawPreeditString(QPainter &painter, int &x, int y, const kpPreeditText &preeditText) const
 {
+    // (the font doesn't change in here so measure with the same metrics)
+    const QFontMetrics fontMetrics = painter.fontMetrics ();
+
     int i = 0;
     const QString& preeditString = preeditText.preeditString ();
     QString str;
@@ -73,18 +78,18 @@ void kpTextSelection::drawPreeditString(QPainter &painter, int &x, int y, const
         {
             str = preeditString.mid (i, start - i);
             painter.drawText (x, y, str);
-            x += painter.fontMetrics().horizontalAdvance(str);
+            x += fontMetrics.horizontalAdvance(str);
         }
 
         painter.save();
         str = preeditString.mid (start, length);
-        int width = painter.fontMetrics().horizontalAdvance(str);
+        int width = fontMetrics.horizontalAdvance(str);
         if (format.background ().color () != Qt::black)
         {
             painter.save ();
             painter.setPen (format.background ().color ());
             painter.setBrush (format.background());
-            painter.drawRect (x, y - painter.fontMetrics ().ascent (), width, painter.fontMetrics ().height ());
+            painter.drawRect (x, y - fontMetrics.ascent (), width, fontMetrics.height ());
             painter.restore ();
         }
         if (format.foreground ().color () != Qt::black)
@@ -94,7 +99,7 @@ void kpTextSelection::drawPreeditString(QPainter &painter, int &x, int y, const
         }
         if (format.underlineStyle ())
         {
-            painter.drawLine (x, y + painter.fontMetrics ().descent (), x + width, y + painter.fontMetrics ().descent ());
+            painter.drawLine (x, y + fontMetrics.descent (), x + width, y + fontMetrics.descent ());
         }
         painter.drawText (x, y, str);
 
@@ -107,44 +112,39 @@ void kpTextSelection::drawPreeditString(QPainter &painter, int &x, int y, const
     {
         str = preeditString.mid (i);
         painter.drawText (x, y, str);
-        x += painter.fontMetrics().horizontalAdvance(str);
+        x += fontMetrics.horizontalAdvance(str);
     }
 }
 
 //---------------------------------------------------------------------
 
-// public virtual [kpAbstractSelection]
-void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
+// Returns the rectangle, relative to the top-left of the text box, that
+// the text of line <row> is drawn in.  It is padded by half a line above
+// and below for glyphs that reach outside the font's ascent and descent.
+static QRect TextLineRect (const QRect &wholeAreaRect, const QRect &textAreaRect,
+        const QFontMetrics &fontMetrics, int row)
 {
-#if DEBUG_KP_SELECTION
-    qCDebug(kpLogLayers) << "kpTextSelection::paint() textStyle: fcol="
-            << (int *) d->textStyle.foregroundColor ().toQRgb ()
-            << " bcol="
-            << (int *) d->textStyle.backgroundColor ().toQRgb ();
-#endif
+    const int lineTop = textAreaRect.y () + row * fontMetrics.lineSpacing ();
+    const int padding = fontMetrics.height () / 2;
 
-    // Drawing text is slow so if the text box will be rendered completely
-    // outside of <destRect>, don't bother rendering it at all.
-    const QRect modifyingRect = docRect.intersected (boundingRect ());
-    if (modifyingRect.isEmpty ()) {
-        return;
-    }
+    return QRect (wholeAreaRect.x (), lineTop - padding,
+                  wholeAreaRect.width (), fontMetrics.height () + padding * 2);
+}
 
+//---------------------------------------------------------------------
 
-    // Is the text box completely invisible?
-    if (textStyle ().foregroundColor ().isTransparent () &&
-        textStyle ().backgroundColor ().isTransparent ())
-    {
+// private
+void kpTextSelection::renderText (const QRegion &region) const
+{
+    QRect theWholeAreaRect, theTextAreaRect;
+    theWholeAreaRect = boundingRect ().translated (-topLeft ());
+    theTextAreaRect = textAreaRect ().translated (-topLeft ());
+
+    const QRegion clipRegion = region.intersected (theWholeAreaRect);
+    if (clipRegion.isEmpty ()) {
         return;
     }
 
-    kpImage floatImage(modifyingRect.size(), QImage::Format_ARGB32_Premultiplied);
-    floatImage.fill(0);
-
-    QRect theWholeAreaRect, theTextAreaRect;
-    theWholeAreaRect = boundingRect ().translated (-modifyingRect.topLeft ());
-    theTextAreaRect = textAreaRect ().translated (-modifyingRect.topLeft ());
-
     QList <QString> theTextLines = textLines();
     kpTextStyle theTextStyle = textStyle();
 
@@ -157,9 +157,23 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
                << " ascent=" << fontMetrics.ascent ()
                << " descent=" << fontMetrics.descent ()
                << " lineSpacing=" << fontMetrics.lineSpacing ();
+    qCDebug(kpLogLayers) << "\tregion=" << clipRegion.boundingRect ();
 #endif
 
-    QPainter painter(&floatImage);
+    // Only the lines touching <region> need drawing; the painter clips the
+    // rest of their neighbours.
+    const auto lineIsInRegion = [&] (int row) {
+        return clipRegion.intersects (::TextLineRect (theWholeAreaRect,
+            theTextAreaRect, fontMetrics, row));
+    };
+
+    QPainter painter(&d->renderedImage);
+    painter.setClipRegion(clipRegion);
+
+    // Forget what was rendered here before.
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(theWholeAreaRect, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
 
     // Fill in the background using the transparent/opaque tool setting
     if ( theTextStyle.isBackgroundTransparent() ) {
@@ -169,7 +183,6 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
       painter.fillRect(theWholeAreaRect, theTextStyle.backgroundColor().toQColor());
     }
 
-    painter.setClipRect(theWholeAreaRect);
     painter.setPen(theTextStyle.foregroundColor().toQColor());
     painter.setFont(theTextStyle.font());
 
@@ -181,10 +194,14 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
       painter.setCompositionMode(QPainter::CompositionMode_Clear);
 
       int baseLine = theTextAreaRect.y () + fontMetrics.ascent ();
+      int row = 0;
       for (const auto &str : theTextLines)
       {
-          painter.drawText (theTextAreaRect.x (), baseLine, str);
+          if (lineIsInRegion (row)) {
+              painter.drawText (theTextAreaRect.x (), baseLine, str);
+          }
           baseLine += fontMetrics.lineSpacing ();
+          row++;
 
           // if the next textline would already be below the visible text area, stop drawing
           if ( (baseLine - fontMetrics.ascent()) > (theTextAreaRect.y() + theTextAreaRect.height()) ) {
@@ -205,7 +222,7 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
 
     if ( theTextLines.isEmpty() )
     {
-        if ( ! thePreeditText.isEmpty() )
+        if ( ! thePreeditText.isEmpty() && lineIsInRegion (0) )
         {
             int x = theTextAreaRect.x();
             drawPreeditString(painter, x, baseLine, thePreeditText);
@@ -218,7 +235,11 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
         int col = thePreeditText.position().x();
         for (const auto &str : theTextLines)
         {
-            if (row == i && !thePreeditText.isEmpty())
+            if (!lineIsInRegion (i))
+            {
+                // (not changed - already rendered)
+            }
+            else if (row == i && !thePreeditText.isEmpty())
             {
                 QString left = str.left(col);
                 QString right = str.mid(col);
@@ -242,12 +263,104 @@ void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
             }
         }
     }
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTextSelection::updateRenderedImage () const
+{
+    const QRect theWholeAreaRect = boundingRect ().translated (-topLeft ());
+
+    // Resized the text box, changed the style or added the first / removed
+    // the last line?  Everything moves - render the whole text box.
+    if (d->renderedImage.size () != theWholeAreaRect.size () ||
+        d->renderedTextStyle != d->textStyle ||
+        d->renderedTextLines.isEmpty () || d->textLines.isEmpty ())
+    {
+    #if DEBUG_KP_SELECTION
+        qCDebug(kpLogLayers) << "kpTextSelection::updateRenderedImage() everything";
+    #endif
+        d->renderedImage = kpImage (theWholeAreaRect.size (),
+            QImage::Format_ARGB32_Premultiplied);
+        renderText (QRegion (theWholeAreaRect));
+    }
+    else
+    {
+        const QRect theTextAreaRect = textAreaRect ().translated (-topLeft ());
+        const QFontMetrics fontMetrics (d->textStyle.font ());
+
+        // Typing normally changes just one line (or, with Enter/Backspace
+        // at the ends of lines, moves the lines below it).
+        QRegion changedRegion;
+        const int rows = qMax (d->textLines.count (), d->renderedTextLines.count ());
+        for (int row = 0; row < rows; row++)
+        {
+            if (row >= d->textLines.count () ||
+                row >= d->renderedTextLines.count () ||
+                d->textLines [row] != d->renderedTextLines [row])
+            {
+                changedRegion += ::TextLineRect (theWholeAreaRect,
+                    theTextAreaRect, fontMetrics, row);
+            }
+        }
+
+        for (const int row : qAsConst (d->changedPreeditRows))
+        {
+            changedRegion += ::TextLineRect (theWholeAreaRect,
+                theTextAreaRect, fontMetrics, row);
+        }
+
+    #if DEBUG_KP_SELECTION
+        qCDebug(kpLogLayers) << "kpTextSelection::updateRenderedImage() changed="
+                             << changedRegion.boundingRect ();
+    #endif
+        if (!changedRegion.isEmpty ()) {
+            renderText (changedRegion);
+        }
+    }
+
+    d->renderedTextLines = d->textLines;
+    d->renderedTextStyle = d->textStyle;
+    d->changedPreeditRows.clear ();
+}
+
+//---------------------------------------------------------------------
+
+// public virtual [kpAbstractSelection]
+void kpTextSelection::paint(QImage *destPixmap, const QRect &docRect) const
+{
+#if DEBUG_KP_SELECTION
+    qCDebug(kpLogLayers) << "kpTextSelection::paint() textStyle: fcol="
+            << (int *) d->textStyle.foregroundColor ().toQRgb ()
+            << " bcol="
+            << (int *) d->textStyle.backgroundColor ().toQRgb ();
+#endif
+
+    // Drawing text is slow so if the text box will be rendered completely
+    // outside of <destRect>, don't bother rendering it at all.
+    const QRect modifyingRect = docRect.intersected (boundingRect ());
+    if (modifyingRect.isEmpty ()) {
+        return;
+    }
+
+
+    // Is the text box completely invisible?
+    if (textStyle ().foregroundColor ().isTransparent () &&
+        textStyle ().backgroundColor ().isTransparent ())
+    {
+        return;
+    }
+
+    // Drawing text is slow so it is only done when the text changes, not on
+    // every repaint (e.g. when the text cursor blinks).
+    updateRenderedImage ();
 
     // ... convert that into "painting" transparent pixels on top of
     // the document.
     kpPixmapFX::paintPixmapAt (destPixmap,
         modifyingRect.topLeft () - docRect.topLeft (),
-        floatImage);
+        d->renderedImage, modifyingRect.translated (-topLeft ()));
 }
 
 //---------------------------------------------------------------------
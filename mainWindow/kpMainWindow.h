@@ -431,6 +431,8 @@ private slots:
     void slotCopyToFile ();
     void slotPasteFromFile ();
 
+    void slotCommandTimings ();
+
 
 //
 // View Menu
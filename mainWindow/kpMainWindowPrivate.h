@@ -164,6 +164,7 @@ struct kpMainWindowPrivate
       actionDeselect(nullptr),
       actionCopyToFile(nullptr),
       actionPasteFromFile(nullptr),
+      actionCommandTimings(nullptr),
 
       copyToFirstTime(false),
 
@@ -341,7 +342,8 @@ struct kpMainWindowPrivate
           *actionPaste, *actionPasteInNewWindow,
           *actionDelete,
           *actionSelectAll, *actionDeselect,
-          *actionCopyToFile, *actionPasteFromFile;
+          *actionCopyToFile, *actionPasteFromFile,
+          *actionCommandTimings;
 
   QUrl lastCopyToURL;
   kpDocumentSaveOptions lastCopyToSaveOptions;
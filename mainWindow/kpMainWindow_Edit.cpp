@@ -48,6 +48,8 @@
 #include "layers/selections/image/kpAbstractImageSelection.h"
 #include "widgets/toolbars/kpColorToolBar.h"
 #include "commands/kpCommandHistory.h"
+#include "commands/kpCommandTimings.h"
+#include "dialogs/kpCommandTimingsDialog.h"
 #include "document/kpDocument.h"
 #include "imagelib/kpDocumentMetaInfo.h"
 #include "document/kpDocumentSaveOptions.h"
@@ -116,6 +118,13 @@ void kpMainWindow::setupEditMenuActions ()
     connect (d->actionPasteFromFile, &QAction::triggered, this, &kpMainWindow::slotPasteFromFile);
 
 
+    // (only shown if enabled by the "Timings Limit" undo setting)
+    d->actionCommandTimings = ac->addAction (QStringLiteral("edit_command_timings"));
+    d->actionCommandTimings->setText (i18n ("Command &Timings..."));
+    d->actionCommandTimings->setVisible (d->commandHistory->commandTimings () != nullptr);
+    connect (d->actionCommandTimings, &QAction::triggered, this, &kpMainWindow::slotCommandTimings);
+
+
     d->editMenuDocumentActionsEnabled = false;
     enableEditMenuDocumentActions (false);
 
@@ -921,3 +930,17 @@ void kpMainWindow::slotPasteFromFile ()
 }
 
 //---------------------------------------------------------------------
+
+// private slot
+void kpMainWindow::slotCommandTimings ()
+{
+    kpCommandTimings *timings = d->commandHistory->commandTimings ();
+    if (!timings) {
+        return;
+    }
+
+    kpCommandTimingsDialog dialog (timings, this);
+    dialog.exec ();
+}
+
+//---------------------------------------------------------------------
@@ -104,6 +104,9 @@ public:
                                const QImage &srcPixmap);
     static void paintPixmapAt (QImage *destPixmapPtr, int destX, int destY,
                                const QImage &srcPixmap);
+    // (draws only the <srcRect> part of <srcPixmap>, without copying it)
+    static void paintPixmapAt (QImage *destPixmapPtr, const QPoint &destAt,
+                               const QImage &srcPixmap, const QRect &srcRect);
 
     //
     // Returns the colour of the pixel at <at> in <pm>.
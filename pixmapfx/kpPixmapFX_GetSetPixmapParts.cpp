@@ -120,6 +120,17 @@ void kpPixmapFX::paintPixmapAt (QImage *destPtr, int destX, int destY,
 
 //---------------------------------------------------------------------
 
+// public static
+void kpPixmapFX::paintPixmapAt (QImage *destPtr, const QPoint &destAt,
+                                const QImage &src, const QRect &srcRect)
+{
+    // draw image with SourceOver composition mode
+    QPainter painter(destPtr);
+    painter.drawImage(destAt, src, srcRect);
+}
+
+//---------------------------------------------------------------------
+
 // public static
 kpColor kpPixmapFX::getColorAtPixel (const QImage &img, const QPoint &at)
 {
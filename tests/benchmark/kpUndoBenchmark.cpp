@@ -0,0 +1,547 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+//
+// Measures how long kpCommandHistory takes to execute, undo and redo
+// scripted sequences of typical commands, and how much memory the history
+// holds while doing so.
+//
+// Each workload loads an image (tests/*.png, plus synthetic large images)
+// into a kpDocument of a main window that is never shown, then runs
+// strokes, fills, effects, transforms and a selection move on it.
+// Everything is undone and then redone.  The results are written as JSON.
+//
+// It also checks that kpViewManager repaints two disjoint dirty rectangles,
+// merged into one frame, without repainting the gap between them.  The
+// benchmark fails if it does.
+//
+// Run with QT_QPA_PLATFORM=offscreen (the default if unset) to stay
+// headless.
+//
+
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QThreadPool>
+
+#include <functional>
+
+#include "commands/kpCommandHistory.h"
+#include "commands/kpMacroCommand.h"
+#include "commands/imagelib/effects/kpEffectFlattenCommand.h"
+#include "commands/imagelib/effects/kpEffectGrayscaleCommand.h"
+#include "commands/imagelib/effects/kpEffectInvertCommand.h"
+#include "commands/imagelib/effects/kpEffectReduceColorsCommand.h"
+#include "commands/imagelib/transforms/kpTransformFlipCommand.h"
+#include "commands/imagelib/transforms/kpTransformResizeScaleCommand.h"
+#include "commands/imagelib/transforms/kpTransformRotateCommand.h"
+#include "commands/tools/flow/kpToolFlowCommand.h"
+#include "commands/tools/kpToolFloodFillCommand.h"
+#include "commands/tools/selection/kpToolSelectionMoveCommand.h"
+#include "commands/tools/selection/kpToolSelectionPullFromDocumentCommand.h"
+#include "document/kpDocument.h"
+#include "environments/commands/kpCommandEnvironment.h"
+#include "imagelib/kpColor.h"
+#include "imagelib/kpLineIterator.h"
+#include "imagelib/kpPainter.h"
+#include "layers/selections/image/kpRectangularImageSelection.h"
+#include "mainWindow/kpMainWindow.h"
+#include "views/manager/kpViewManager.h"
+
+//---------------------------------------------------------------------
+
+struct Step
+{
+    QString name;
+
+    // Performs the step, adding exactly one command to the history.
+    std::function <void ()> run;
+};
+
+//---------------------------------------------------------------------
+
+static qint64 NsecsToRun (const std::function <void ()> &func)
+{
+    QElapsedTimer timer;
+    timer.start ();
+
+    func ();
+
+    return timer.nsecsElapsed ();
+}
+
+//---------------------------------------------------------------------
+
+// Lets background undo compression finish and report back.
+static void WaitForBackgroundWork ()
+{
+    QThreadPool::globalInstance ()->waitForDone ();
+    QCoreApplication::processEvents ();
+}
+
+//---------------------------------------------------------------------
+
+// Draws a freehand-like stroke across the document, the way
+// kpToolFlowBase would, as a kpToolFlowCommand.
+static void Stroke (kpMainWindow *mainWindow, const QPoint &from, const QPoint &to)
+{
+    kpDocument *doc = mainWindow->document ();
+    const int brushSize = 5;
+
+    auto *cmd = new kpToolFlowCommand (QStringLiteral ("Brush"),
+        mainWindow->commandEnvironment ());
+
+    for (kpLineIterator <> it (from, to); !it.atEnd (); it.next ())
+    {
+        const QPoint &p = it.point ();
+        const QRect dab = QRect (p.x () - brushSize / 2, p.y () - brushSize / 2,
+                                 brushSize, brushSize).intersected (doc->rect ());
+        if (dab.isEmpty ()) {
+            continue;
+        }
+
+        cmd->aboutToModify (dab);
+        kpPainter::fillRect (doc->imagePointer (),
+            dab.x (), dab.y (), dab.width (), dab.height (),
+            kpColor::Red);
+        doc->slotContentsChanged (dab);
+
+        cmd->updateBoundingRect (dab);
+    }
+
+    cmd->finalize ();
+    mainWindow->commandHistory ()->addCommand (cmd, false/*no exec*/);
+}
+
+//---------------------------------------------------------------------
+
+static void FloodFill (kpMainWindow *mainWindow, const QPoint &at, const kpColor &color)
+{
+    auto *cmd = new kpToolFloodFillCommand (at.x (), at.y (), color,
+        0/*color similarity*/, mainWindow->commandEnvironment ());
+    cmd->execute ();
+
+    mainWindow->commandHistory ()->addCommand (cmd, false/*no exec*/);
+}
+
+//---------------------------------------------------------------------
+
+static void SelectionMove (kpMainWindow *mainWindow, const QRect &rect, const QPoint &by)
+{
+    kpCommandEnvironment *environ = mainWindow->commandEnvironment ();
+
+    // (kpToolSelection would first add a kpToolSelectionCreateCommand for
+    //  the border but, as that does not touch the document, it is skipped)
+    const kpRectangularImageSelection border (rect, kpImageSelectionTransparency ());
+
+    auto *pullCmd = new kpToolSelectionPullFromDocumentCommand (border,
+        kpColor::White, QStringLiteral ("Selection: Move"), environ);
+    pullCmd->execute ();
+
+    auto *moveCmd = new kpToolSelectionMoveCommand (QStringLiteral ("Selection: Move"),
+        environ);
+    moveCmd->moveTo (rect.topLeft () + by);
+    moveCmd->finalize ();
+
+    auto *macroCmd = new kpMacroCommand (QStringLiteral ("Selection: Move"), environ);
+    macroCmd->addCommand (pullCmd);
+    macroCmd->addCommand (moveCmd);
+
+    mainWindow->commandHistory ()->addCommand (macroCmd, false/*no exec*/);
+}
+
+//---------------------------------------------------------------------
+
+static QList <Step> Script (kpMainWindow *mainWindow)
+{
+    kpCommandEnvironment *environ = mainWindow->commandEnvironment ();
+    kpCommandHistory *commandHistory = mainWindow->commandHistory ();
+    kpDocument *doc = mainWindow->document ();
+
+    const int w = doc->width (), h = doc->height ();
+
+    auto addCommand = [commandHistory] (kpCommand *cmd) {
+        commandHistory->addCommand (cmd);
+    };
+
+    QList <Step> steps;
+
+    steps << Step {QStringLiteral ("stroke (horizontal)"), [=] () {
+        ::Stroke (mainWindow, QPoint (0, h / 3), QPoint (w - 1, h / 3));
+    }};
+    steps << Step {QStringLiteral ("stroke (diagonal)"), [=] () {
+        ::Stroke (mainWindow, QPoint (0, 0), QPoint (w - 1, h - 1));
+    }};
+    steps << Step {QStringLiteral ("flood fill (corner)"), [=] () {
+        ::FloodFill (mainWindow, QPoint (0, h - 1), kpColor::Blue);
+    }};
+    steps << Step {QStringLiteral ("flood fill (center)"), [=] () {
+        ::FloodFill (mainWindow, QPoint (w / 2, h / 2), kpColor::Yellow);
+    }};
+    steps << Step {QStringLiteral ("effect: invert"), [=] () {
+        addCommand (new kpEffectInvertCommand (false/*act on doc*/, environ));
+    }};
+    steps << Step {QStringLiteral ("effect: grayscale"), [=] () {
+        addCommand (new kpEffectGrayscaleCommand (false/*act on doc*/, environ));
+    }};
+    steps << Step {QStringLiteral ("effect: flatten"), [=] () {
+        addCommand (new kpEffectFlattenCommand (Qt::black, Qt::white,
+            false/*act on doc*/, environ));
+    }};
+    steps << Step {QStringLiteral ("effect: reduce colors"), [=] () {
+        addCommand (new kpEffectReduceColorsCommand (1/*depth*/, false/*dither*/,
+            false/*act on doc*/, environ));
+    }};
+    steps << Step {QStringLiteral ("transform: flip"), [=] () {
+        addCommand (new kpTransformFlipCommand (false/*act on doc*/,
+            true/*horiz*/, false/*vert*/, environ));
+    }};
+    steps << Step {QStringLiteral ("transform: rotate 90"), [=] () {
+        addCommand (new kpTransformRotateCommand (false/*act on doc*/, 90, environ));
+    }};
+    steps << Step {QStringLiteral ("transform: scale 150%"), [=] () {
+        addCommand (new kpTransformResizeScaleCommand (false/*act on doc*/,
+            doc->width () * 3 / 2, doc->height () * 3 / 2,
+            kpTransformResizeScaleCommand::Scale, environ));
+    }};
+    steps << Step {QStringLiteral ("transform: rotate 270"), [=] () {
+        addCommand (new kpTransformRotateCommand (false/*act on doc*/, 270, environ));
+    }};
+    // (last, so that the other steps don't act on the floating selection)
+    steps << Step {QStringLiteral ("selection move"), [=] () {
+        const QRect rect (doc->width () / 4, doc->height () / 4,
+                          doc->width () / 4, doc->height () / 4);
+        ::SelectionMove (mainWindow, rect,
+            QPoint (doc->width () / 8, doc->height () / 8));
+    }};
+
+    return steps;
+}
+
+//---------------------------------------------------------------------
+
+static QJsonObject RunWorkload (kpMainWindow *mainWindow,
+        const QString &name, const QImage &image)
+{
+    kpCommandHistory *commandHistory = mainWindow->commandHistory ();
+
+    commandHistory->clear ();
+
+    auto *doc = new kpDocument (image.width (), image.height (),
+        mainWindow->documentEnvironment ());
+    doc->setImage (image.convertToFormat (QImage::Format_ARGB32_Premultiplied));
+    mainWindow->setDocument (doc);
+
+    const QList <Step> steps = ::Script (mainWindow);
+
+    QJsonArray commands;
+    kpCommandSize::SizeType peakResidentSize = 0;
+
+    // Execute
+    for (const Step &step : steps)
+    {
+        const qint64 ns = ::NsecsToRun (step.run);
+        const kpCommandSize::SizeType residentSize = commandHistory->residentSize ();
+        peakResidentSize = qMax (peakResidentSize, residentSize);
+
+        QJsonObject command;
+        command [QStringLiteral ("step")] = step.name;
+        command [QStringLiteral ("command")] = commandHistory->nextUndoCommand () ?
+            commandHistory->nextUndoCommand ()->name () : QString ();
+        command [QStringLiteral ("execute_ns")] = ns;
+        command [QStringLiteral ("resident_bytes_after_execute")] = residentSize;
+        commands.append (command);
+    }
+
+    const kpCommandSize::SizeType residentSizeBeforeCompression =
+        commandHistory->residentSize ();
+    ::WaitForBackgroundWork ();
+    const kpCommandSize::SizeType residentSizeAfterCompression =
+        commandHistory->residentSize ();
+
+    // Undo (most recent first)
+    //
+    // Commands trimmed off the history by the undo limits cannot be undone
+    // and so get no unexecute or reexecute times.
+    int numUndone = 0;
+    for (int i = commands.size () - 1; i >= 0 && commandHistory->nextUndoCommand (); i--)
+    {
+        numUndone++;
+
+        const qint64 ns = ::NsecsToRun ([commandHistory] () { commandHistory->undo (); });
+
+        QJsonObject command = commands [i].toObject ();
+        command [QStringLiteral ("unexecute_ns")] = ns;
+        commands [i] = command;
+    }
+
+    ::WaitForBackgroundWork ();
+
+    // Redo
+    for (int i = commands.size () - numUndone; i < commands.size (); i++)
+    {
+        const qint64 ns = ::NsecsToRun ([commandHistory] () { commandHistory->redo (); });
+
+        QJsonObject command = commands [i].toObject ();
+        command [QStringLiteral ("reexecute_ns")] = ns;
+        commands [i] = command;
+    }
+
+    QJsonObject workload;
+    workload [QStringLiteral ("name")] = name;
+    workload [QStringLiteral ("width")] = image.width ();
+    workload [QStringLiteral ("height")] = image.height ();
+    workload [QStringLiteral ("commands")] = commands;
+    workload [QStringLiteral ("peak_resident_bytes")] = peakResidentSize;
+    workload [QStringLiteral ("resident_bytes_before_compression")] =
+        residentSizeBeforeCompression;
+    workload [QStringLiteral ("resident_bytes_after_compression")] =
+        residentSizeAfterCompression;
+
+    return workload;
+}
+
+//---------------------------------------------------------------------
+
+// Waits for kpViewManager to flush the updates it is holding back for the
+// next display frame.
+static void WaitForViewUpdateFlush (kpViewManager *viewManager)
+{
+    const qint64 flushes = viewManager->updateStatistics ().flushes;
+
+    QElapsedTimer timer;
+    timer.start ();
+
+    while (viewManager->updateStatistics ().flushes == flushes &&
+           timer.elapsed () < 1000)
+    {
+        QCoreApplication::processEvents (QEventLoop::AllEvents, 10);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Marks two small rectangles, at opposite corners of the document, dirty
+// within one display frame and returns how much of the views that repaints,
+// compared with marking the whole document dirty.
+static QJsonObject RunDisjointViewUpdate (kpMainWindow *mainWindow)
+{
+    auto *doc = new kpDocument (1024, 1024, mainWindow->documentEnvironment ());
+    mainWindow->setDocument (doc);
+
+    kpViewManager *viewManager = mainWindow->viewManager ();
+
+    // Let anything pending from setDocument() go first.
+    ::WaitForViewUpdateFlush (viewManager);
+
+    viewManager->resetUpdateStatistics ();
+    viewManager->updateViews (doc->rect ());
+    ::WaitForViewUpdateFlush (viewManager);
+    const qint64 wholePaintedPixels = viewManager->updateStatistics ().paintedPixels;
+
+    viewManager->resetUpdateStatistics ();
+    viewManager->updateViews (QRect (0, 0, 1, 1));
+    viewManager->updateViews (QRect (doc->width () - 1, doc->height () - 1, 1, 1));
+    ::WaitForViewUpdateFlush (viewManager);
+    const kpViewManager::UpdateStatistics stats = viewManager->updateStatistics ();
+
+    // Each rectangle is rounded out to a small tile, so repainting the gap
+    // between them as well would repaint about the whole document.
+    const bool gapRepainted = (stats.paintedPixels * 4 > wholePaintedPixels);
+
+    QJsonObject result;
+    result [QStringLiteral ("requests")] = stats.requests;
+    result [QStringLiteral ("merged")] = stats.merged;
+    result [QStringLiteral ("flushes")] = stats.flushes;
+    result [QStringLiteral ("painted_pixels")] = stats.paintedPixels;
+    result [QStringLiteral ("whole_document_painted_pixels")] = wholePaintedPixels;
+    result [QStringLiteral ("gap_repainted")] = gapRepainted;
+
+    return result;
+}
+
+//---------------------------------------------------------------------
+
+// Returns line art: flat color with thin lines, like a scanned drawing.
+static QImage SyntheticLineArt (const QSize &size)
+{
+    QImage image (size, QImage::Format_ARGB32_Premultiplied);
+    image.fill (Qt::white);
+
+    QPainter painter (&image);
+    painter.setPen (Qt::black);
+    for (int i = 0; i < size.width () + size.height (); i += 37)
+    {
+        painter.drawLine (i, 0, i - size.height (), size.height ());
+        painter.drawEllipse (QPoint (i % size.width (), (i * 7) % size.height ()), 50, 30);
+    }
+
+    return image;
+}
+
+// Returns a smooth gradient with noise, like a photo.
+static QImage SyntheticPhoto (const QSize &size)
+{
+    QImage image (size, QImage::Format_ARGB32_Premultiplied);
+
+    quint32 seed = 1;
+    for (int y = 0; y < size.height (); y++)
+    {
+        auto *line = reinterpret_cast <QRgb *> (image.scanLine (y));
+        for (int x = 0; x < size.width (); x++)
+        {
+            seed = seed * 1103515245 + 12345;
+            const int noise = static_cast <int> ((seed >> 16) & 0x1F);
+
+            line [x] = qRgb ((x * 255 / size.width () + noise) & 0xFF,
+                             (y * 255 / size.height () + noise) & 0xFF,
+                             ((x + y) & 0xFF) ^ noise);
+        }
+    }
+
+    return image;
+}
+
+//---------------------------------------------------------------------
+
+int main (int argc, char *argv [])
+{
+    if (qEnvironmentVariableIsEmpty ("QT_QPA_PLATFORM")) {
+        qputenv ("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app (argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription (QStringLiteral (
+        "Measures KolourPaint undo/redo latency and memory use."));
+    parser.addHelpOption ();
+
+    const QCommandLineOption imagesDirOption (QStringLiteral ("images-dir"),
+        QStringLiteral ("Directory of *.png images to run the workloads on."),
+        QStringLiteral ("dir"), QStringLiteral (KP_BENCHMARK_IMAGES_DIR));
+    const QCommandLineOption syntheticSizeOption (QStringLiteral ("synthetic-size"),
+        QStringLiteral ("Size of the synthetic images, as WIDTHxHEIGHT (0x0 for none)."),
+        QStringLiteral ("size"), QStringLiteral ("4000x3000"));
+    const QCommandLineOption outputOption (QStringLiteral ("output"),
+        QStringLiteral ("Write the JSON results to <file> instead of stdout."),
+        QStringLiteral ("file"));
+    parser.addOptions ({imagesDirOption, syntheticSizeOption, outputOption});
+    parser.process (app);
+
+
+    auto *mainWindow = new kpMainWindow ();
+
+    QJsonArray workloads;
+
+    const QDir imagesDir (parser.value (imagesDirOption));
+    const QStringList imageFiles =
+        imagesDir.entryList ({QStringLiteral ("*.png")}, QDir::Files, QDir::Name);
+    for (const QString &imageFile : imageFiles)
+    {
+        const QImage image (imagesDir.filePath (imageFile));
+        if (image.isNull ()) {
+            continue;
+        }
+
+        workloads.append (::RunWorkload (mainWindow, imageFile, image));
+    }
+
+    const QStringList syntheticSize =
+        parser.value (syntheticSizeOption).split (QLatin1Char ('x'));
+    const QSize size = (syntheticSize.size () == 2) ?
+        QSize (syntheticSize [0].toInt (), syntheticSize [1].toInt ()) :
+        QSize ();
+    if (!size.isEmpty ())
+    {
+        workloads.append (::RunWorkload (mainWindow,
+            QStringLiteral ("synthetic line art"), ::SyntheticLineArt (size)));
+        workloads.append (::RunWorkload (mainWindow,
+            QStringLiteral ("synthetic photo"), ::SyntheticPhoto (size)));
+    }
+
+
+    const QJsonObject disjointViewUpdate = ::RunDisjointViewUpdate (mainWindow);
+
+
+    kpCommandHistory *commandHistory = mainWindow->commandHistory ();
+
+    QJsonObject settings;
+    settings [QStringLiteral ("undo_min_limit")] = commandHistory->undoMinLimit ();
+    settings [QStringLiteral ("undo_max_limit")] = commandHistory->undoMaxLimit ();
+    settings [QStringLiteral ("undo_max_limit_size_limit")] =
+        commandHistory->undoMaxLimitSizeLimit ();
+    settings [QStringLiteral ("undo_uncompressed_limit")] =
+        commandHistory->undoUncompressedLimit ();
+    settings [QStringLiteral ("undo_spill_size_limit")] =
+        commandHistory->undoSpillSizeLimit ();
+
+    QJsonObject results;
+    results [QStringLiteral ("settings")] = settings;
+    results [QStringLiteral ("workloads")] = workloads;
+    results [QStringLiteral ("disjoint_view_update")] = disjointViewUpdate;
+
+    delete mainWindow;
+
+
+    const QByteArray json = QJsonDocument (results).toJson ();
+
+    if (parser.isSet (outputOption))
+    {
+        QFile file (parser.value (outputOption));
+        if (!file.open (QIODevice::WriteOnly) || file.write (json) != json.size ())
+        {
+            qCritical ("Could not write %s", qPrintable (file.fileName ()));
+            return 1;
+        }
+    }
+    else
+    {
+        QFile out;
+        out.open (stdout, QIODevice::WriteOnly);
+        out.write (json);
+    }
+
+    if (disjointViewUpdate [QStringLiteral ("gap_repainted")].toBool ())
+    {
+        qCritical ("Two disjoint view updates repainted the gap between them");
+        return 1;
+    }
+
+    return 0;
+}
@@ -30,6 +30,8 @@
 #include "kpToolColorEraser.h"
 
 #include <QApplication>
+#include <QPolygon>
+#include <QRegion>
 
 #include "kpLogCategories.h"
 #include <KLocalizedString>
@@ -42,6 +44,7 @@
 #include "pixmapfx/kpPixmapFX.h"
 #include "commands/tools/flow/kpToolFlowCommand.h"
 #include "environments/tools/kpToolEnvironment.h"
+#include "views/manager/kpViewManager.h"
 
 //--------------------------------------------------------------------------------
 
@@ -76,6 +79,7 @@ void kpToolColorEraser::globalDraw ()
 
     kpToolFlowCommand *cmd = new kpToolFlowCommand (
         i18n ("Color Eraser"), environ ()->commandEnvironment ());
+    cmd->aboutToModify (document ()->rect ());
 
     const QRect dirtyRect = kpPainter::washRect (document ()->imagePointer (),
         0, 0, document ()->width (), document ()->height (),
@@ -136,6 +140,11 @@ QRect kpToolColorEraser::drawLine (const QPoint &thisPoint, const QPoint &lastPo
 
     environ ()->flashColorSimilarityToolBarItem ();
 
+    // (sync: kpPainter::washLine() never writes outside this rectangle)
+    currentCommand ()->aboutToModify (
+        neededRect (kpPainter::normalizedRect (thisPoint, lastPoint),
+                    qMax (brushWidth (), brushHeight ())));
+
     const QRect dirtyRect = kpPainter::washLine (document ()->imagePointer (),
         lastPoint.x (), lastPoint.y (),
         thisPoint.x (), thisPoint.y (),
@@ -158,3 +167,54 @@ QRect kpToolColorEraser::drawLine (const QPoint &thisPoint, const QPoint &lastPo
 }
 
 //--------------------------------------------------------------------------------
+
+// protected virtual [base kpToolFlowBase]
+void kpToolColorEraser::drawPolyline (const QPolygon &points,
+        const QPolygon & /*viewPoints*/)
+{
+    const QPolygon movedPoints = withoutRepeatedPoints (points);
+    if (movedPoints.count () < 2) {
+        return;
+    }
+
+#if DEBUG_KP_TOOL_COLOR_ERASER
+    qCDebug(kpLogTools) << "kpToolColorEraser::drawPolyline(points="
+                        << movedPoints << ")";
+#endif
+
+    if (!drawShouldProceed (QPoint ()/*unused*/, QPoint ()/*unused*/, QRect ()/*unused*/)) {
+        return;
+    }
+
+    environ ()->flashColorSimilarityToolBarItem ();
+
+    // (sync: kpPainter::washPolyline() never writes outside this region)
+    const QRegion docRegion = neededRegion (movedPoints);
+
+    viewManager ()->setFastUpdates ();
+    {
+        currentCommand ()->aboutToModify (docRegion);
+
+        const QRect dirtyRect = kpPainter::washPolyline (document ()->imagePointer (),
+            movedPoints,
+            color (mouseButton ())/*color to draw in*/,
+            brushWidth (), brushHeight (),
+            color (1 - mouseButton ())/*color to replace*/,
+            processedColorSimilarity ());
+
+    #if DEBUG_KP_TOOL_COLOR_ERASER
+        qCDebug(kpLogTools) << "\tdirtyRect=" << dirtyRect;
+    #endif
+
+        if (!dirtyRect.isEmpty ())
+        {
+            document ()->slotContentsChanged (dirtyRect);
+            currentCommand ()->updateBoundingRect (docRegion.intersected (dirtyRect));
+        }
+    }
+    viewManager ()->restoreFastUpdates ();
+
+    setUserShapePoints (movedPoints.last ());
+}
+
+//--------------------------------------------------------------------------------
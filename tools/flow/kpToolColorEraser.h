@@ -59,6 +59,7 @@ protected:
 
 
     QRect drawLine (const QPoint &thisPoint, const QPoint &lastPoint) override;
+    void drawPolyline (const QPolygon &points, const QPolygon &viewPoints) override;
 };
 
 
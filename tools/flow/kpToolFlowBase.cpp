@@ -34,10 +34,14 @@
 
 #include <QImage>
 #include <QPainter>
+#include <QPolygon>
+#include <QRegion>
+#include <QRandomGenerator>
 
 #include "kpLogCategories.h"
 #include <KLocalizedString>
 
+#include "imagelib/kpBrushStamp.h"
 #include "imagelib/kpColor.h"
 #include "commands/kpCommandHistory.h"
 #include "cursors/kpCursorProvider.h"
@@ -45,6 +49,7 @@
 #include "document/kpDocument.h"
 #include "imagelib/kpImage.h"
 #include "imagelib/kpPainter.h"
+#include "imagelib/kpStrokeRandom.h"
 #include "pixmapfx/kpPixmapFX.h"
 #include "environments/tools/kpToolEnvironment.h"
 #include "commands/tools/flow/kpToolFlowCommand.h"
@@ -82,8 +87,11 @@ struct kpToolFlowBasePrivate
 
         bool brushIsDiagonalLine{};
 
+        kpBrushStamp brushStamp;
+
 
     kpToolFlowCommand *currentCommand{};
+    kpStrokeRandom strokeRandom;
 };
 
 //---------------------------------------------------------------------
@@ -132,6 +140,8 @@ void kpToolFlowBase::clearBrushCursorData ()
     d->cursorWidth = d->cursorHeight = 0;
 
     d->brushIsDiagonalLine = false;
+
+    d->brushStamp = kpBrushStamp ();
 }
 
 //---------------------------------------------------------------------
@@ -207,6 +217,7 @@ void kpToolFlowBase::end ()
 void kpToolFlowBase::beginDraw ()
 {
     d->currentCommand = new kpToolFlowCommand (text (), environ ()->commandEnvironment ());
+    d->strokeRandom.setSeed (QRandomGenerator::global ()->generate ());
 
     // We normally show the brush cursor in the foreground colour but if the
     // user starts drawing in the background color, we don't want to leave
@@ -290,6 +301,82 @@ void kpToolFlowBase::draw (const QPoint &thisPoint, const QPoint &lastPoint, con
 
 //---------------------------------------------------------------------
 
+// protected virtual [base kpTool]
+void kpToolFlowBase::drawPolyline (const QPolygon &points, const QPolygon &viewPoints)
+{
+    // Mouse moves that don't leave the document pixel (common when zoomed
+    // in, or with a high-rate tablet) would only redraw the brush on top
+    // of itself, so drop them.
+    QPolygon movedPoints, movedViewPoints;
+    movedPoints.reserve (points.count ());
+    movedViewPoints.reserve (viewPoints.count ());
+    for (int i = 0; i < points.count (); i++)
+    {
+        if (movedPoints.isEmpty () || points [i] != movedPoints.last ())
+        {
+            movedPoints.append (points [i]);
+            movedViewPoints.append (viewPoints [i]);
+        }
+    }
+
+    if (movedPoints.count () < 2) {
+        return;
+    }
+
+#if DEBUG_KP_TOOL_FLOW_BASE && 0
+    qCDebug(kpLogTools) << "kpToolFlowBase::drawPolyline() points=" << points.count ()
+                        << " moved=" << movedPoints.count ();
+#endif
+
+    // Keep the whole polyline in one fast update (draw() nests inside).
+    viewManager ()->setFastUpdates ();
+    {
+        kpTool::drawPolyline (movedPoints, movedViewPoints);
+    }
+    viewManager ()->restoreFastUpdates ();
+}
+
+//---------------------------------------------------------------------
+
+// protected static
+QPolygon kpToolFlowBase::withoutRepeatedPoints (const QPolygon &points)
+{
+    QPolygon ret;
+    ret.reserve (points.count ());
+
+    for (const QPoint &point : points)
+    {
+        if (ret.isEmpty () || point != ret.last ()) {
+            ret.append (point);
+        }
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
+// protected
+QRegion kpToolFlowBase::neededRegion (const QPolygon &points) const
+{
+    const int brushSize = qMax (brushWidth (), brushHeight ());
+
+    if (points.count () == 1) {
+        return neededRect (QRect (points [0], points [0]), brushSize);
+    }
+
+    QRegion ret;
+    for (int i = 1; i < points.count (); i++)
+    {
+        ret += neededRect (kpPainter::normalizedRect (points [i - 1], points [i]),
+                           brushSize);
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+
 // virtual
 void kpToolFlowBase::cancelShape ()
 {
@@ -317,8 +404,7 @@ void kpToolFlowBase::releasedAllButtons ()
 void kpToolFlowBase::endDraw (const QPoint &, const QRect &)
 {
     d->currentCommand->finalize ();
-    environ ()->commandHistory ()->addCommand (d->currentCommand,
-        false/*don't exec*/);
+    environ ()->commandHistory ()->addFlowCommand (d->currentCommand);
 
     // don't delete - it's up to the commandHistory
     d->currentCommand = nullptr;
@@ -381,6 +467,19 @@ bool kpToolFlowBase::brushIsDiagonalLine () const
 }
 
 
+// protected
+const kpBrushStamp &kpToolFlowBase::brushStamp () const
+{
+    return d->brushStamp;
+}
+
+// protected
+kpStrokeRandom *kpToolFlowBase::strokeRandom () const
+{
+    return &d->strokeRandom;
+}
+
+
 // protected
 kpToolFlowCommand *kpToolFlowBase::currentCommand () const
 {
@@ -413,6 +512,11 @@ void kpToolFlowBase::updateBrushAndCursor ()
                 d->toolWidgetEraserSize->eraserSize ();
 
         d->brushIsDiagonalLine = false;
+
+        kpToolWidgetEraserSize::DrawPackage stampPackage =
+            d->toolWidgetEraserSize->drawFunctionData (kpColor::Black);
+        d->brushStamp = kpBrushStamp (d->brushDrawFunc, &stampPackage,
+            d->brushWidth, d->brushHeight);
     }
     else if (haveDiverseBrushes ())
     {
@@ -430,6 +534,11 @@ void kpToolFlowBase::updateBrushAndCursor ()
                 d->toolWidgetBrush->brushSize ();
 
         d->brushIsDiagonalLine = d->toolWidgetBrush->brushIsDiagonalLine ();
+
+        kpToolWidgetBrush::DrawPackage stampPackage =
+            d->toolWidgetBrush->drawFunctionData (kpColor::Black);
+        d->brushStamp = kpBrushStamp (d->brushDrawFunc, &stampPackage,
+            d->brushWidth, d->brushHeight);
     }
 
     hover (hasBegun () ? currentPoint () : calculateCurrentPoint ());
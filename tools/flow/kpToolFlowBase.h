@@ -37,9 +37,13 @@
 
 
 class QPoint;
+class QPolygon;
+class QRegion;
 class QString;
 
+class kpBrushStamp;
 class kpColor;
+class kpStrokeRandom;
 class kpToolFlowCommand;
 
 
@@ -80,6 +84,16 @@ class kpToolFlowBase : public kpTool
     void endDraw(const QPoint &, const QRect &) override;
 
   protected:
+    void drawPolyline(const QPolygon &points, const QPolygon &viewPoints) override;
+
+    // Returns <points> without the points that repeat the one before (mouse
+    // moves that didn't leave the document pixel).
+    static QPolygon withoutRepeatedPoints(const QPolygon &points);
+
+    // Returns the area that the brush can change when drawn along the
+    // polyline through <points> (the union of neededRect() of each line).
+    QRegion neededRegion(const QPolygon &points) const;
+
     virtual QString haventBegunDrawUserMessage() const = 0;
 
     virtual bool haveSquareBrushes() const { return false; }
@@ -99,6 +113,14 @@ class kpToolFlowBase : public kpTool
 
     bool brushIsDiagonalLine() const;
 
+    // Returns the pixels covered by the brush, for drawing it quickly
+    // (null if the tool doesn't have brushes).
+    const kpBrushStamp &brushStamp() const;
+
+    // Random number generator for the current stroke, reseeded by
+    // beginDraw().
+    kpStrokeRandom *strokeRandom() const;
+
     kpToolFlowCommand *currentCommand() const;
     virtual kpColor color(int which);
     QRect hotRect() const;
@@ -28,11 +28,17 @@
 
 #include "kpToolFlowPixmapBase.h"
 
+#include "imagelib/kpBrushStamp.h"
 #include "imagelib/kpColor.h"
+#include "imagelib/kpLineIterator.h"
 #include "document/kpDocument.h"
 #include "imagelib/kpPainter.h"
 #include "pixmapfx/kpPixmapFX.h"
 #include "commands/tools/flow/kpToolFlowCommand.h"
+#include "views/manager/kpViewManager.h"
+
+#include <QPolygon>
+#include <QRegion>
 
 //---------------------------------------------------------------------
 
@@ -45,37 +51,144 @@ kpToolFlowPixmapBase::kpToolFlowPixmapBase (const QString &text, const QString &
 
 //---------------------------------------------------------------------
 
+// Calls <func> with the top-left of the brush at each point of the line
+// from <lastPoint> to <thisPoint>.
+template <typename Func>
+static void ForEachBrushTopLeft (const QPoint &thisPoint, const QPoint &lastPoint,
+        bool cardinalAdjacency, int brushWidth, int brushHeight,
+        Func func)
+{
+    if (cardinalAdjacency)
+    {
+        for (kpLineIterator <true> it (lastPoint, thisPoint); !it.atEnd (); it.next ())
+        {
+            func (kpToolFlowBase::hotRectForMousePointAndBrushWidthHeight (
+                it.point (), brushWidth, brushHeight).topLeft ());
+        }
+    }
+    else
+    {
+        for (kpLineIterator <false> it (lastPoint, thisPoint); !it.atEnd (); it.next ())
+        {
+            func (kpToolFlowBase::hotRectForMousePointAndBrushWidthHeight (
+                it.point (), brushWidth, brushHeight).topLeft ());
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+
 QRect kpToolFlowPixmapBase::drawLine (const QPoint &thisPoint, const QPoint &lastPoint)
 {
     QRect docRect = kpPainter::normalizedRect(thisPoint, lastPoint);
     docRect = neededRect (docRect, qMax (brushWidth (), brushHeight ()));
-    kpImage image = document ()->getImageAt (docRect);
-
-
-    QList <QPoint> points = kpPainter::interpolatePoints (lastPoint, thisPoint,
-        brushIsDiagonalLine ());
 
-    foreach (const QPoint &p, points)
+    if (brushStamp ().canDrawOn (*document ()->imagePointer ()))
     {
-        const QPoint point =
-            hotRectForMousePointAndBrushWidthHeight(p, brushWidth(), brushHeight())
-                    .topLeft() - docRect.topLeft();
-
-        // OPT: This may be redrawing pixels that were drawn on a previous
-        //      iteration, since the brush is usually bigger than 1 pixel.
-        //      Maybe we could use QRegion to determine all the non-intersecting
-        //      regions and only draw each region once.
-        //
-        //      Try this at least for the easy case of the Eraser, which has
-        //      square, simply-filled brushes.  Profiling needs to be done as
-        //      QRegion is known to be a CPU hog.
-        brushDrawFunction () (&image, point, brushDrawFunctionData ());
+        QList <QPoint> topLefts;
+        topLefts.reserve (qMax (qAbs (thisPoint.x () - lastPoint.x ()),
+                                qAbs (thisPoint.y () - lastPoint.y ())) * 2 + 1);
+        ::ForEachBrushTopLeft (thisPoint, lastPoint,
+            brushIsDiagonalLine (), brushWidth (), brushHeight (),
+            [&topLefts] (const QPoint &topLeft) { topLefts.append (topLeft); });
+
+        // Stamp straight into the document.  Each pixel covered by the
+        // stamps, overlapping or not, is only written once.
+        currentCommand ()->aboutToModify (docRect);
+        const QRect dirtyRect = brushStamp ().draw (document ()->imagePointer (),
+            topLefts, color (mouseButton ()));
+
+        if (!dirtyRect.isEmpty ()) {
+            document ()->slotContentsChanged (dirtyRect);
+        }
+
+        return dirtyRect;
     }
 
 
+    kpImage image = document ()->getImageAt (docRect);
+
+    const kpTempImage::UserFunctionType drawFunc = brushDrawFunction ();
+    void * const drawFuncData = brushDrawFunctionData ();
+    const QPoint docTopLeft = docRect.topLeft ();
+
+    // OPT: This may be redrawing pixels that were drawn on a previous
+    //      iteration, since the brush is usually bigger than 1 pixel.
+    //      kpBrushStamp, above, avoids this but only handles
+    //      documents in the usual format.
+    ::ForEachBrushTopLeft (thisPoint, lastPoint,
+        brushIsDiagonalLine (), brushWidth (), brushHeight (),
+        [&] (const QPoint &topLeft)
+        {
+            drawFunc (&image, topLeft - docTopLeft, drawFuncData);
+        });
+
+
+    currentCommand ()->aboutToModify (docRect);
     document ()->setImageAt (image, docRect.topLeft ());
     return docRect;
 }
 
 //---------------------------------------------------------------------
 
+// protected virtual [base kpToolFlowBase]
+void kpToolFlowPixmapBase::drawPolyline (const QPolygon &points,
+        const QPolygon &viewPoints)
+{
+    if (!brushStamp ().canDrawOn (*document ()->imagePointer ()))
+    {
+        // (draws a line at a time)
+        kpToolFlowBase::drawPolyline (points, viewPoints);
+        return;
+    }
+
+    const QPolygon movedPoints = withoutRepeatedPoints (points);
+    if (movedPoints.count () < 2) {
+        return;
+    }
+
+    if (!/*virtual*/drawShouldProceed (movedPoints.last (),
+            movedPoints [movedPoints.count () - 2], normalizedRect ()))
+    {
+        return;
+    }
+
+    // Collect the brush positions of the whole polyline, leaving out its
+    // first point, which was drawn with the previous polyline.
+    QList <QPoint> topLefts;
+    for (int i = 1; i < movedPoints.count (); i++)
+    {
+        bool isFirstPoint = true;
+        ::ForEachBrushTopLeft (movedPoints [i], movedPoints [i - 1],
+            brushIsDiagonalLine (), brushWidth (), brushHeight (),
+            [&] (const QPoint &topLeft)
+            {
+                if (!isFirstPoint) {
+                    topLefts.append (topLeft);
+                }
+                isFirstPoint = false;
+            });
+    }
+
+    const QRegion docRegion = neededRegion (movedPoints);
+
+    viewManager ()->setFastUpdates ();
+    {
+        // Stamp straight into the document, in one go.  Each pixel covered
+        // by the stamps, overlapping or not, is only written once.
+        currentCommand ()->aboutToModify (docRegion);
+        const QRect dirtyRect = brushStamp ().draw (document ()->imagePointer (),
+            topLefts, color (mouseButton ()));
+
+        if (!dirtyRect.isEmpty ())
+        {
+            document ()->slotContentsChanged (dirtyRect);
+            currentCommand ()->updateBoundingRect (docRegion.intersected (dirtyRect));
+        }
+    }
+    viewManager ()->restoreFastUpdates ();
+
+    setUserShapePoints (movedPoints.last ());
+}
+
+//---------------------------------------------------------------------
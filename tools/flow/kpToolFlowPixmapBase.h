@@ -52,6 +52,8 @@ public:
 
 protected:
     QRect drawLine (const QPoint &thisPoint, const QPoint &lastPoint) override;
+
+    void drawPolyline (const QPolygon &points, const QPolygon &viewPoints) override;
 };
 
 
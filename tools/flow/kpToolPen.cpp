@@ -77,6 +77,7 @@ QRect kpToolPen::drawLine (const QPoint &thisPoint, const QPoint &lastPoint)
   painter.setPen(color(mouseButton()).toQColor());
   painter.drawLine(sp, ep);
 
+  currentCommand ()->aboutToModify (docRect);
   document ()->setImageAt (image, docRect.topLeft ());
   return docRect;
 }
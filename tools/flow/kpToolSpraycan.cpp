@@ -32,6 +32,7 @@
 
 #include "kpDefs.h"
 #include "document/kpDocument.h"
+#include "imagelib/kpLineIterator.h"
 #include "imagelib/kpPainter.h"
 #include "pixmapfx/kpPixmapFX.h"
 #include "environments/tools/kpToolEnvironment.h"
@@ -125,9 +126,15 @@ QRect kpToolSpraycan::drawLineWithProbability (const QPoint &thisPoint,
                << ")";
 #endif
 
-    QList <QPoint> docPoints = kpPainter::interpolatePoints (lastPoint, thisPoint,
-        false/*no need for cardinally adjacency points*/,
-        probability);
+    Q_ASSERT (probability >= 0.0 && probability <= 1.0);
+    QList <QPoint> docPoints;
+    for (kpLineIterator <false/*no need for cardinally adjacency points*/, true>
+            it (lastPoint, thisPoint, qRound (probability * 1000), strokeRandom ());
+         !it.atEnd ();
+         it.next ())
+    {
+        docPoints.append (it.point ());
+    }
 #if DEBUG_KP_TOOL_SPRAYCAN
     qCDebug(kpLogTools) << "\tdocPoints=" << docPoints;
 #endif
@@ -139,34 +146,32 @@ QRect kpToolSpraycan::drawLineWithProbability (const QPoint &thisPoint,
     }
 
 
-    // For efficiency, only get image after NOP check above.
     QRect docRect = kpPainter::normalizedRect(thisPoint, lastPoint);
     docRect = neededRect (docRect, spraycanSize ());
-    kpImage image = document ()->getImageAt (docRect);
 
+    currentCommand ()->aboutToModify (docRect);
 
-    // Spray at each point, onto the image.
+
+    // Spray at each point, straight onto the document.
     //
     // Note in passing: Unlike other tools such as the Brush, drawing
     //                  over the same point does result in a different
     //                  appearance.
-
-    QList <QPoint> imagePoints;
-    for (const auto &dp : docPoints)
-        imagePoints.append (dp - docRect.topLeft ());
-
-    kpPainter::sprayPoints (&image,
-        imagePoints,
+    const QRect dirtyRect = kpPainter::sprayPoints (document ()->imagePointer (),
+        docPoints,
         color (mouseButton ()),
-        spraycanSize ());
-
+        spraycanSize (),
+        strokeRandom ());
 
-    viewManager ()->setFastUpdates ();
-    document ()->setImageAt (image, docRect.topLeft ());
-    viewManager ()->restoreFastUpdates ();
+    if (!dirtyRect.isEmpty ())
+    {
+        viewManager ()->setFastUpdates ();
+        document ()->slotContentsChanged (dirtyRect);
+        viewManager ()->restoreFastUpdates ();
+    }
 
 
-    return docRect;
+    return dirtyRect;
 }
 
 // public virtual [base kpToolFlowBase]
@@ -35,6 +35,8 @@
 
 #include <climits>
 
+#include <QTimer>
+
 #include <KActionCollection>
 #include "kpLogCategories.h"
 #include <KLocalizedString>
@@ -72,6 +74,12 @@ kpTool::kpTool(const QString &text, const QString &description,
     d->userShapeEndPoint = KP_INVALID_POINT;
     d->userShapeSize = KP_INVALID_SIZE;
 
+    d->drawBatchTimer = new QTimer (this);
+    d->drawBatchTimer->setSingleShot (true);
+    connect (d->drawBatchTimer, &QTimer::timeout, this, &kpTool::flushPendingDraws);
+    d->isDrawingBatch = false;
+    d->userShapeChangedDuringBatch = false;
+
     d->environ = environ;
 
     setObjectName(name);
@@ -47,6 +47,7 @@ class QFocusEvent;
 class QInputMethodEvent;
 class QKeyEvent;
 class QMouseEvent;
+class QPolygon;
 class QImage;
 class QWheelEvent;
 
@@ -228,9 +229,31 @@ protected:
     virtual void draw (const QPoint &thisPoint, const QPoint &lastPoint,
                         const QRect &normalizedRect);
 
+    // Called with the points of all the mouse moves, made while drawing, that
+    // arrived during one display frame.  <points> starts with lastPoint(),
+    // which has already been drawn, followed by the new points in order.
+    // <viewPoints> are the same points in view coordinates.
+    //
+    // The default implementation calls draw() for each new point, with
+    // currentPoint() and lastPoint() set as if the moves had been handled one
+    // at a time.  Reimplement this if you can draw the whole polyline in one
+    // pass.  currentPoint() and lastPoint() are then updated afterwards.
+    //
+    // Either way, the views are repainted, and the status bar is told about
+    // setUserShapePoints(), once for the whole polyline.
+    virtual void drawPolyline (const QPolygon &points, const QPolygon &viewPoints);
+
 private:
     void drawInternal ();
 
+    // Queues up the mouse move to <point> (<viewPoint> in view coordinates)
+    // and draws the queued moves, if a frame has passed since the last time.
+    void queueDraw (const QPoint &point, const QPoint &viewPoint);
+    // Draws the queued mouse moves, with drawPolyline().
+    void flushPendingDraws ();
+    // Forgets the queued mouse moves, without drawing them.
+    void clearPendingDraws ();
+
 protected:
     // (m_mouseButton will not change from beginDraw())
     virtual void cancelShape ();
@@ -32,6 +32,8 @@
 #include "kpToolColorPicker.h"
 #include "kpLogCategories.h"
 #include "widgets/toolbars/kpColorToolBar.h"
+#include "widgets/toolbars/kpToolToolBar.h"
+#include "widgets/toolbars/options/kpToolWidgetColorPickerSize.h"
 #include "commands/kpCommandHistory.h"
 #include "kpDefs.h"
 #include "document/kpDocument.h"
@@ -44,7 +46,9 @@
 kpToolColorPicker::kpToolColorPicker (kpToolEnvironment *environ, QObject *parent)
     : kpTool (i18n ("Color Picker"), i18n ("Lets you select a color from the image"),
               Qt::Key_C,
-              environ, parent, QStringLiteral("tool_color_picker"))
+              environ, parent, QStringLiteral("tool_color_picker")),
+      m_toolWidgetColorPickerSize (nullptr),
+      m_document (nullptr)
 {
 }
 
@@ -58,7 +62,37 @@ kpColor kpToolColorPicker::colorAtPixel (const QPoint &p)
     qCDebug(kpLogTools) << "kpToolColorPicker::colorAtPixel" << p;
 #endif
 
-    return kpPixmapFX::getColorAtPixel (document ()->image (), p);
+    // (don't take a copy of the document image - it would be detached by
+    //  the next change to the document)
+    const kpImage &image = *document ()->imagePointer ();
+
+    const int size = m_toolWidgetColorPickerSize ?
+        m_toolWidgetColorPickerSize->colorPickerSize () : 1;
+    if (size <= 1 || !image.rect ().contains (p)) {
+        return kpPixmapFX::getColorAtPixel (image, p);
+    }
+
+    if (m_document != document ())
+    {
+        // Not begin()'ed with this document: don't trust the tables.
+        m_summedAreaTable.clear ();
+    }
+
+    return m_summedAreaTable.averageColor (image,
+        QRect (p.x () - size / 2, p.y () - size / 2, size, size));
+}
+
+
+// private slot
+void kpToolColorPicker::slotDocumentContentsChanged (const QRect &docRect)
+{
+    m_summedAreaTable.invalidate (docRect);
+}
+
+// private slot
+void kpToolColorPicker::slotDocumentSizeChanged ()
+{
+    m_summedAreaTable.clear ();
 }
 
 
@@ -72,6 +106,23 @@ QString kpToolColorPicker::haventBegunDrawUserMessage () const
 // public virtual [base kpTool]
 void kpToolColorPicker::begin ()
 {
+    kpToolToolBar *tb = toolToolBar ();
+    Q_ASSERT (tb);
+
+    m_toolWidgetColorPickerSize = tb->toolWidgetColorPickerSize ();
+    m_toolWidgetColorPickerSize->show ();
+
+    // Keep the averaging tables in step with the document, tile by tile.
+    m_document = document ();
+    if (m_document)
+    {
+        connect (m_document, &kpDocument::contentsChanged,
+                 this, &kpToolColorPicker::slotDocumentContentsChanged);
+        connect (m_document,
+                 static_cast<void (kpDocument::*)(const QSize &)>(&kpDocument::sizeChanged),
+                 this, &kpToolColorPicker::slotDocumentSizeChanged);
+    }
+
     setUserMessage (haventBegunDrawUserMessage ());
 }
 
@@ -134,4 +185,16 @@ void kpToolColorPicker::endDraw (const QPoint &thisPoint, const QRect &)
     }
 }
 
+// public virtual [base kpTool]
+void kpToolColorPicker::end ()
+{
+    if (m_document)
+    {
+        disconnect (m_document, nullptr, this, nullptr);
+        m_document = nullptr;
+    }
+
+    m_summedAreaTable.clear ();
 
+    m_toolWidgetColorPickerSize = nullptr;
+}
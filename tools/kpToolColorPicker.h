@@ -31,12 +31,16 @@
 
 
 #include "imagelib/kpColor.h"
+#include "imagelib/kpImageSummedAreaTable.h"
 #include "tools/kpTool.h"
 
 
 class QPoint;
 class QRect;
 
+class kpDocument;
+class kpToolWidgetColorPickerSize;
+
 
 class kpToolColorPicker : public kpTool
 {
@@ -51,6 +55,8 @@ public:
     bool returnToPreviousToolAfterEndDraw () const override { return true; }
 
 private:
+    // Returns the color at <p> or, with a color picker size above 1x1, the
+    // average color of the square centered on <p>.
     kpColor colorAtPixel (const QPoint &p);
 
     QString haventBegunDrawUserMessage () const;
@@ -62,9 +68,20 @@ public:
     void cancelShape () override;
     void releasedAllButtons () override;
     void endDraw (const QPoint &thisPoint, const QRect &) override;
+    void end () override;
+
+private slots:
+    void slotDocumentContentsChanged (const QRect &docRect);
+    void slotDocumentSizeChanged ();
 
 private:
     kpColor m_oldColor;
+
+    kpToolWidgetColorPickerSize *m_toolWidgetColorPickerSize;
+
+    // The document that <m_summedAreaTable> has been kept up to date with.
+    kpDocument *m_document;
+    kpImageSummedAreaTable m_summedAreaTable;
 };
 
 
@@ -30,6 +30,8 @@
 #define kpToolPrivate_H
 
 
+#include <QElapsedTimer>
+#include <QList>
 #include <QPoint>
 #include <QPointer>
 
@@ -39,6 +41,8 @@
   #undef environ  // macro on win32
 #endif
 
+class QTimer;
+
 class kpToolAction;
 class kpToolEnvironment;
 
@@ -59,10 +63,18 @@ struct kpToolPrivate
     bool shiftPressed, controlPressed, altPressed;  // m_altPressed is unreliable
     QPoint startPoint,
            currentPoint, currentViewPoint,
-           lastPoint;
+           lastPoint, lastViewPoint;
 
     kpView *viewUnderStartPoint;
 
+    // Input batching: the mouse moves, made while drawing, that haven't been
+    // drawn yet (see kpTool::flushPendingDraws()).
+    QList <QPoint> pendingDrawPoints, pendingDrawViewPoints;
+    QTimer *drawBatchTimer;
+    QElapsedTimer lastDrawBatchTime;
+    bool isDrawingBatch;
+    bool userShapeChangedDuringBatch;
+
 
     // Set to 2 when the user swaps the foreground and background color.
     //
@@ -37,6 +37,8 @@
 #include "kpToolPrivate.h"
 
 #include <QApplication>
+#include <QPolygon>
+#include <QTimer>
 
 #include "kpLogCategories.h"
 
@@ -310,10 +312,135 @@ void kpTool::drawInternal ()
 
 //---------------------------------------------------------------------
 
+// protected virtual
+void kpTool::drawPolyline (const QPolygon &points, const QPolygon &viewPoints)
+{
+    Q_ASSERT (points.count () == viewPoints.count ());
+
+    for (int i = 1; i < points.count () && d->beganDraw; i++)
+    {
+        d->currentPoint = points [i];
+        d->currentViewPoint = viewPoints [i];
+
+        drawInternal ();
+
+        d->lastPoint = d->currentPoint;
+        d->lastViewPoint = d->currentViewPoint;
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTool::queueDraw (const QPoint &point, const QPoint &viewPoint)
+{
+    d->pendingDrawPoints.append (point);
+    d->pendingDrawViewPoints.append (viewPoint);
+
+    if (d->drawBatchTimer->isActive ()) {
+        return;
+    }
+
+    // High-rate mice and tablets can send several moves per frame.  Draw
+    // the first one straight away but then collect the rest until the next
+    // frame - there is no point updating the screen more often than that.
+    const int frameInterval = kpViewManager::frameIntervalMsec ();
+    const qint64 sinceLastBatch = d->lastDrawBatchTime.isValid () ?
+        d->lastDrawBatchTime.elapsed () : frameInterval;
+
+    if (sinceLastBatch >= frameInterval) {
+        flushPendingDraws ();
+    }
+    else {
+        d->drawBatchTimer->start (int (frameInterval - sinceLastBatch));
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTool::flushPendingDraws ()
+{
+    // (e.g. endShape() called from inside drawPolyline())
+    if (d->isDrawingBatch) {
+        return;
+    }
+
+    d->drawBatchTimer->stop ();
+
+    if (d->pendingDrawPoints.isEmpty ()) {
+        return;
+    }
+
+    d->lastDrawBatchTime.start ();
+
+    if (!d->beganDraw)
+    {
+        clearPendingDraws ();
+        return;
+    }
+
+    QPolygon points, viewPoints;
+    points.reserve (1 + d->pendingDrawPoints.count ());
+    viewPoints.reserve (1 + d->pendingDrawViewPoints.count ());
+    points.append (d->lastPoint);
+    viewPoints.append (d->lastViewPoint);
+    for (int i = 0; i < d->pendingDrawPoints.count (); i++)
+    {
+        points.append (d->pendingDrawPoints [i]);
+        viewPoints.append (d->pendingDrawViewPoints [i]);
+    }
+
+#if DEBUG_KP_TOOL && 0
+    qCDebug(kpLogTools) << "kpTool::flushPendingDraws() points=" << points;
+#endif
+
+    d->isDrawingBatch = true;
+    d->userShapeChangedDuringBatch = false;
+
+    viewManager ()->setQueueUpdates ();
+    {
+        drawPolyline (points, viewPoints);
+    }
+    viewManager ()->restoreQueueUpdates ();
+
+    d->isDrawingBatch = false;
+    clearPendingDraws ();
+
+    if (d->beganDraw)
+    {
+        d->currentPoint = d->lastPoint = points.last ();
+        d->currentViewPoint = d->lastViewPoint = viewPoints.last ();
+    }
+
+    if (d->userShapeChangedDuringBatch)
+    {
+        d->userShapeChangedDuringBatch = false;
+
+        emit userShapePointsChanged (d->userShapeStartPoint, d->userShapeEndPoint);
+        emit userShapeSizeChanged (d->userShapeSize);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// private
+void kpTool::clearPendingDraws ()
+{
+    d->drawBatchTimer->stop ();
+
+    d->pendingDrawPoints.clear ();
+    d->pendingDrawViewPoints.clear ();
+}
+
+//---------------------------------------------------------------------
+
 
 // also called by kpView
 void kpTool::cancelShapeInternal ()
 {
+    clearPendingDraws ();
+
     if (hasBegunShape ())
     {
         d->beganDraw = false;
@@ -362,6 +489,9 @@ void kpTool::endDrawInternal (const QPoint &thisPoint, const QRect &normalizedRe
     qCDebug(kpLogTools) << "kpTool::endDrawInternal() wantEndShape=" << wantEndShape;
 #endif
 
+    // Draw any mouse moves that are still queued up before they are lost.
+    flushPendingDraws ();
+
     if (wantEndShape && !hasBegunShape ()) {
         return;
     }
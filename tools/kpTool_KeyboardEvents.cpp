@@ -377,7 +377,9 @@ void kpTool::notifyModifierStateChanged ()
 {
     if (careAboutModifierState ())
     {
-        if (d->beganDraw) {
+        if (d->beganDraw)
+        {
+            flushPendingDraws ();
             draw (d->currentPoint, d->lastPoint, normalizedRect ());
         }
         else
@@ -144,7 +144,7 @@ void kpTool::mousePressEvent (QMouseEvent *e)
     d->startPoint = d->currentPoint = view->transformViewToDoc (e->pos ());
     d->currentViewPoint = e->pos ();
     d->viewUnderStartPoint = view;
-    d->lastPoint = QPoint (-1, -1);
+    d->lastPoint = d->lastViewPoint = QPoint (-1, -1);
 
 #if DEBUG_KP_TOOL && 1
     qCDebug(kpLogTools) << "\tBeginning draw @ " << d->currentPoint;
@@ -154,6 +154,7 @@ void kpTool::mousePressEvent (QMouseEvent *e)
 
     draw (d->currentPoint, d->lastPoint, QRect (d->currentPoint, d->currentPoint));
     d->lastPoint = d->currentPoint;
+    d->lastViewPoint = d->currentViewPoint;
 }
 
 //---------------------------------------------------------------------
@@ -214,15 +215,17 @@ void kpTool::mouseMoveEvent (QMouseEvent *e)
             // the screen resulting in ugly tearing of the viewManager's
             // tempImage.
             viewManager ()->setFastUpdates ();
-        }
-
-        drawInternal ();
-
-        if (dragScrolled) {
+            {
+                queueDraw (d->currentPoint, d->currentViewPoint);
+                flushPendingDraws ();
+            }
             viewManager ()->restoreFastUpdates ();
         }
-
-        d->lastPoint = d->currentPoint;
+        else
+        {
+            // (draws now or, if we already drew this frame, at the next one)
+            queueDraw (d->currentPoint, d->currentViewPoint);
+        }
     }
     else
     {
@@ -260,6 +263,8 @@ void kpTool::mouseReleaseEvent (QMouseEvent *e)
         kpView *view = viewUnderStartPoint ();
         Q_ASSERT (view);
 
+        flushPendingDraws ();
+
         d->currentPoint = view->transformViewToDoc (e->pos ());
         d->currentViewPoint = e->pos ();
 
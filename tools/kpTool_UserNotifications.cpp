@@ -103,7 +103,14 @@ void kpTool::setUserShapePoints (const QPoint &startPoint,
 {
     d->userShapeStartPoint = startPoint;
     d->userShapeEndPoint = endPoint;
-    emit userShapePointsChanged (d->userShapeStartPoint, d->userShapeEndPoint);
+
+    // (flushPendingDraws() tells the status bar once, at the end)
+    if (d->isDrawingBatch) {
+        d->userShapeChangedDuringBatch = true;
+    }
+    else {
+        emit userShapePointsChanged (d->userShapeStartPoint, d->userShapeEndPoint);
+    }
 
     if (setSize)
     {
@@ -151,7 +158,12 @@ void kpTool::setUserShapeSize (const QSize &size)
 {
     d->userShapeSize = size;
 
-    emit userShapeSizeChanged (d->userShapeSize);
+    if (d->isDrawingBatch) {
+        d->userShapeChangedDuringBatch = true;
+    }
+    else {
+        emit userShapeSizeChanged (d->userShapeSize);
+    }
 }
 
 //---------------------------------------------------------------------
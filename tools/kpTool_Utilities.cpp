@@ -157,6 +157,8 @@ void kpTool::somethingBelowTheCursorChanged (const QPoint &currentPoint_,
     qCDebug(kpLogTools) << "\tbegan draw=" << d->beganDraw;
 #endif
 
+    flushPendingDraws ();
+
     d->currentPoint = currentPoint_;
     d->currentViewPoint = currentViewPoint_;
 
@@ -166,6 +168,7 @@ void kpTool::somethingBelowTheCursorChanged (const QPoint &currentPoint_,
         {
             draw (d->currentPoint, d->lastPoint, normalizedRect ());
             d->lastPoint = d->currentPoint;
+            d->lastViewPoint = d->currentViewPoint;
         }
     }
     else
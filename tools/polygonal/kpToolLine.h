@@ -43,6 +43,9 @@ public:
 private:
     QString haventBegunShapeUserMessage () const override;
 
+protected:
+    bool previewLinesIncrementally () const override { return true; }
+
 public:
     void endDraw (const QPoint &, const QRect &) override;
 };
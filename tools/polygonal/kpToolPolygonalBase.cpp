@@ -56,7 +56,9 @@
 struct kpToolPolygonalBasePrivate
 {
     kpToolPolygonalBasePrivate ()
-        : drawShapeFunc(nullptr), toolWidgetLineWidth(nullptr), originatingMouseButton(-1)
+        : drawShapeFunc(nullptr), toolWidgetLineWidth(nullptr), originatingMouseButton(-1),
+          incrementalPreviewIsShown(false), fixedLinesPointCount(0), fixedLinesPenWidth(0),
+          fixedLinesAntiAliased(false)
     {
     }
 
@@ -67,10 +69,77 @@ struct kpToolPolygonalBasePrivate
     int originatingMouseButton;
 
     QPolygon points;
+
+    //
+    // Incremental preview (see previewLinesIncrementally())
+    //
+
+        bool incrementalPreviewIsShown;
+
+        // The lines between the first <fixedLinesPointCount> points, which
+        // are no longer being dragged, drawn onto a transparent image at
+        // <fixedLinesRect>.
+        kpImage fixedLinesImage;
+        QRect fixedLinesRect;
+        int fixedLinesPointCount;
+        kpColor fixedLinesColor;
+        int fixedLinesPenWidth;
+        bool fixedLinesAntiAliased;
+
+        // The line being dragged, drawn onto a transparent image.
+        kpImage lastLineImage;
+        QRect lastLineRect;
+
+        // Top-left of the temp image, which covers both of the above.
+        QPoint previewTopLeft;
 };
 
 //---------------------------------------------------------------------
 
+// kpTempImage::UserFunctionType for the incremental preview.
+static void DrawIncrementalPreview (kpImage *destImage, const QPoint &topLeft,
+        void *userData)
+{
+    const auto *d = static_cast <const kpToolPolygonalBasePrivate *> (userData);
+
+    if (!d->fixedLinesImage.isNull ())
+    {
+        kpPixmapFX::paintPixmapAt (destImage,
+            topLeft + (d->fixedLinesRect.topLeft () - d->previewTopLeft),
+            d->fixedLinesImage);
+    }
+
+    if (!d->lastLineImage.isNull ())
+    {
+        kpPixmapFX::paintPixmapAt (destImage,
+            topLeft + (d->lastLineRect.topLeft () - d->previewTopLeft),
+            d->lastLineImage);
+    }
+}
+
+//---------------------------------------------------------------------
+
+// Returns a transparent image of <rect>, with the line from <startPoint> to
+// <endPoint> drawn onto it by <drawShapeFunc>.
+static kpImage DrawLineImage (kpToolPolygonalBase::DrawShapeFunc drawShapeFunc,
+        const QRect &rect,
+        const QPoint &startPoint, const QPoint &endPoint,
+        const kpColor &fcolor, int penWidth, const kpColor &bcolor)
+{
+    kpImage image (rect.size (), QImage::Format_ARGB32_Premultiplied);
+    image.fill (0);
+
+    QPolygon line;
+    line << startPoint << endPoint;
+    line.translate (-rect.x (), -rect.y ());
+
+    (*drawShapeFunc) (&image, line, fcolor, penWidth, bcolor, false/*not final*/);
+
+    return image;
+}
+
+//---------------------------------------------------------------------
+
 kpToolPolygonalBase::kpToolPolygonalBase (
         const QString &text,
         const QString &description,
@@ -391,6 +460,12 @@ void kpToolPolygonalBase::updateShape ()
         return;
     }
 
+    if (/*virtual*/previewLinesIncrementally ())
+    {
+        updateShapeIncrementally ();
+        return;
+    }
+
     const QRect boundingRect = kpTool::neededRect (
             d->points.boundingRect (),
             d->toolWidgetLineWidth->lineWidth ());
@@ -426,10 +501,135 @@ void kpToolPolygonalBase::updateShape ()
     viewManager ()->restoreFastUpdates ();
 }
 
+// private
+void kpToolPolygonalBase::updateShapeIncrementally ()
+{
+    const int count = d->points.count ();
+    Q_ASSERT (count >= 2);
+
+    const kpColor fcolor = drawingForegroundColor ();
+    const kpColor bcolor = /*virtual*/drawingBackgroundColor ();
+    const int penWidth = d->toolWidgetLineWidth->lineWidth ();
+    const bool antiAliased = kpToolEnvironment::drawAntiAliased;
+
+    QRect changedRect;
+
+    // Lines already in the overlay look different now (or are gone)?
+    if (fcolor != d->fixedLinesColor || penWidth != d->fixedLinesPenWidth ||
+        antiAliased != d->fixedLinesAntiAliased ||
+        d->fixedLinesPointCount > count - 1)
+    {
+        if (d->incrementalPreviewIsShown) {
+            changedRect = d->fixedLinesRect.united (d->lastLineRect);
+        }
+
+        d->fixedLinesImage = kpImage ();
+        d->fixedLinesRect = QRect ();
+        d->fixedLinesPointCount = 0;
+        d->fixedLinesColor = fcolor;
+        d->fixedLinesPenWidth = penWidth;
+        d->fixedLinesAntiAliased = antiAliased;
+    }
+
+    // Add the lines that are no longer being dragged to the overlay.
+    // There is normally at most one: the line that was being dragged before
+    // the last point was added.
+    for (int i = qMax (d->fixedLinesPointCount, 1); i < count - 1; i++)
+    {
+        const QRect lineRect = kpTool::neededRect (
+            kpPainter::normalizedRect (d->points [i - 1], d->points [i]),
+            penWidth);
+        const QRect newRect = d->fixedLinesRect.united (lineRect);
+
+        if (newRect != d->fixedLinesRect)
+        {
+            kpImage newImage (newRect.size (), QImage::Format_ARGB32_Premultiplied);
+            newImage.fill (0);
+
+            if (!d->fixedLinesImage.isNull ())
+            {
+                kpPixmapFX::setPixmapAt (&newImage,
+                    d->fixedLinesRect.topLeft () - newRect.topLeft (),
+                    d->fixedLinesImage);
+            }
+
+            d->fixedLinesImage = newImage;
+            d->fixedLinesRect = newRect;
+        }
+
+        QPolygon line;
+        line << d->points [i - 1] << d->points [i];
+        line.translate (-d->fixedLinesRect.x (), -d->fixedLinesRect.y ());
+        (*d->drawShapeFunc) (&d->fixedLinesImage, line,
+            fcolor, penWidth, bcolor, false/*not final*/);
+
+        changedRect = changedRect.united (lineRect);
+    }
+    d->fixedLinesPointCount = qMax (count - 1, d->fixedLinesPointCount);
+
+
+    // Redraw only the line being dragged.
+    const QRect lastLineRect = kpTool::neededRect (
+        kpPainter::normalizedRect (d->points [count - 2], d->points [count - 1]),
+        penWidth);
+
+    changedRect = changedRect.united (d->lastLineRect).united (lastLineRect);
+
+    d->lastLineImage = ::DrawLineImage (d->drawShapeFunc, lastLineRect,
+        d->points [count - 2], d->points [count - 1],
+        fcolor, penWidth, bcolor);
+    d->lastLineRect = lastLineRect;
+
+
+    const QRect previewRect = d->fixedLinesRect.united (d->lastLineRect);
+    d->previewTopLeft = previewRect.topLeft ();
+
+#if DEBUG_KP_TOOL_POLYGON
+    qCDebug(kpLogTools) << "kpToolPolygonalBase::updateShapeIncrementally()"
+               << " previewRect=" << previewRect
+               << " changedRect=" << changedRect;
+#endif
+
+    kpTempImage newTempImage (false/*always display*/,
+                                previewRect.topLeft (),
+                                &::DrawIncrementalPreview, d,
+                                previewRect.width (), previewRect.height ());
+
+    viewManager ()->setFastUpdates ();
+    {
+        if (d->incrementalPreviewIsShown) {
+            viewManager ()->updateTempImage (newTempImage, changedRect);
+        }
+        else {
+            viewManager ()->setTempImage (newTempImage);
+        }
+    }
+    viewManager ()->restoreFastUpdates ();
+
+    d->incrementalPreviewIsShown = true;
+}
+
+// private
+void kpToolPolygonalBase::clearIncrementalPreview ()
+{
+    d->incrementalPreviewIsShown = false;
+
+    d->fixedLinesImage = kpImage ();
+    d->fixedLinesRect = QRect ();
+    d->fixedLinesPointCount = 0;
+    d->fixedLinesColor = kpColor::Invalid;
+    d->fixedLinesPenWidth = 0;
+    d->fixedLinesAntiAliased = false;
+
+    d->lastLineImage = kpImage ();
+    d->lastLineRect = QRect ();
+}
+
 // virtual
 void kpToolPolygonalBase::cancelShape ()
 {
     viewManager ()->invalidateTempImage ();
+    clearIncrementalPreview ();
     d->points.resize (0);
 
     setUserMessage (i18n ("Let go of all the mouse buttons."));
@@ -457,6 +657,7 @@ void kpToolPolygonalBase::endShape (const QPoint &, const QRect &)
     }
 
     viewManager ()->invalidateTempImage ();
+    clearIncrementalPreview ();
 
     QRect boundingRect = kpTool::neededRect (
         d->points.boundingRect (),
@@ -168,6 +168,16 @@ protected:
     // "false".  The Curve tool realizes it is an initial drag if points() only
     // returns 2 points.
     virtual bool drawingALine () const { return true; }
+
+    // Returns true if the shape is nothing more than the lines between
+    // consecutive points(), each drawn by <drawShapeFunc> as if it were a
+    // 2-point shape e.g. a Polyline.
+    //
+    // updateShape() then previews the shape in a transparent overlay, which
+    // it adds to one line at a time, instead of drawing the whole shape
+    // onto a copy of the document on every mouse move.  Only the line being
+    // dragged is redrawn and repainted.
+    virtual bool previewLinesIncrementally () const { return false; }
 public:
     void draw (const QPoint &, const QPoint &, const QRect &) override;
 private:
@@ -181,6 +191,9 @@ protected:
     virtual kpColor drawingBackgroundColor () const;
 protected slots:
     void updateShape ();
+private:
+    void updateShapeIncrementally ();
+    void clearIncrementalPreview ();
 public:
     void cancelShape () override;
     void releasedAllButtons () override;
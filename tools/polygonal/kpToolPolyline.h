@@ -43,6 +43,9 @@ public:
 private:
     QString haventBegunShapeUserMessage () const override;
 
+protected:
+    bool previewLinesIncrementally () const override { return true; }
+
 public:
     // (used by kpToolLine)
     static void drawShape(kpImage *image,
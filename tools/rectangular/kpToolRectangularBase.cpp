@@ -62,10 +62,32 @@ struct kpToolRectangularBasePrivate
     kpToolWidgetFillStyle *toolWidgetFillStyle{};
 
     QRect toolRectangleRect;
+
+    // What updateShape() last asked the views to preview.
+    kpColor previewForegroundColor, previewBackgroundColor;
+    int previewPenWidth{};
 };
 
 //---------------------------------------------------------------------
 
+// kpTempImage::UserFunctionType that draws the shape being dragged out,
+// straight onto the document pixels that a view is repainting.
+static void DrawShapePreview (kpImage *destImage, const QPoint &topLeft,
+        void *userData)
+{
+    const auto *d = static_cast <const kpToolRectangularBasePrivate *> (userData);
+
+    // (<destImage> only covers the part of the document being repainted,
+    //  which the painter clips to)
+    (*d->drawShapeFunc) (destImage,
+        topLeft.x (), topLeft.y (),
+        d->toolRectangleRect.width (), d->toolRectangleRect.height (),
+        d->previewForegroundColor, d->previewPenWidth,
+        d->previewBackgroundColor);
+}
+
+//---------------------------------------------------------------------
+
 kpToolRectangularBase::kpToolRectangularBase (
         const QString &text,
         const QString &description,
@@ -279,18 +301,19 @@ kpColor kpToolRectangularBase::drawingBackgroundColor () const
 // private
 void kpToolRectangularBase::updateShape ()
 {
-    kpImage image = document ()->getImageAt (d->toolRectangleRect);
-
-    // Invoke shape drawing function passed in ctor.
-    (*d->drawShapeFunc) (&image,
-        0, 0, d->toolRectangleRect.width (), d->toolRectangleRect.height (),
-        drawingForegroundColor (), d->toolWidgetLineWidth->lineWidth (),
-        drawingBackgroundColor ());
-
+    d->previewForegroundColor = drawingForegroundColor ();
+    d->previewBackgroundColor = drawingBackgroundColor ();
+    d->previewPenWidth = d->toolWidgetLineWidth->lineWidth ();
+
+    // Don't copy the document and draw the shape here.  Instead, the views
+    // invoke the shape drawing function passed in the ctor, as they paint,
+    // on just the pixels they repaint.  The document itself is only drawn
+    // on by kpToolRectangularCommand, in endDraw().
     kpTempImage newTempImage (false/*always display*/,
-                                kpTempImage::SetImage/*render mode*/,
                                 d->toolRectangleRect.topLeft (),
-                                image);
+                                &::DrawShapePreview, d,
+                                d->toolRectangleRect.width (),
+                                d->toolRectangleRect.height ());
 
     viewManager ()->setFastUpdates ();
     viewManager ()->setTempImage (newTempImage);
@@ -31,7 +31,27 @@
 
 #include "views/kpThumbnailView.h"
 
+#include <QImage>
+#include <QPainter>
+#include <QRegion>
+
 #include "kpLogCategories.h"
+#include "document/kpDocument.h"
+#include "layers/tempImage/kpTempImage.h"
+#include "views/manager/kpViewManager.h"
+
+
+struct kpThumbnailViewPrivate
+{
+    // The document scaled to the zoom level of <scaledImageZoomX> and
+    // <scaledImageZoomY>.  Its top-left pixel is drawn at origin().
+    QImage scaledImage;
+    int scaledImageZoomX, scaledImageZoomY;
+
+    // Document rectangles that have changed since <scaledImage> was
+    // last brought up to date.
+    QRegion dirtyDocRegion;
+};
 
 
 kpThumbnailView::kpThumbnailView (kpDocument *document,
@@ -44,11 +64,24 @@ kpThumbnailView::kpThumbnailView (kpDocument *document,
     : kpView (document, toolToolBar, viewManager,
               buddyView,
               scrollableContainer,
-              parent)
+              parent),
+      d (new kpThumbnailViewPrivate ())
 {
+    d->scaledImageZoomX = d->scaledImageZoomY = 0;
+
+    if (document)
+    {
+        connect (document, &kpDocument::contentsChanged,
+                 this, &kpThumbnailView::slotDocumentContentsChanged);
+        connect (document, static_cast<void (kpDocument::*)(const QSize &)>(&kpDocument::sizeChanged),
+                 this, &kpThumbnailView::slotDocumentSizeChanged);
+    }
 }
 
-kpThumbnailView::~kpThumbnailView () = default;
+kpThumbnailView::~kpThumbnailView ()
+{
+    delete d;
+}
 
 
 // protected
@@ -93,4 +126,138 @@ void kpThumbnailView::resizeEvent (QResizeEvent *e)
 }
 
 
+// private slot
+void kpThumbnailView::slotDocumentContentsChanged (const QRect &docRect)
+{
+    d->dirtyDocRegion += docRect;
+
+    // kpViewManager::updateViews() may have already repainted us in
+    // response to this change, before we got to mark the cache dirty.
+    // Ask for another (cheap, since it only blits from the cache) paint
+    // event to make sure the change shows.
+    if (zoomLevelX () < 100 || zoomLevelY () < 100) {
+        update (transformDocToView (docRect).adjusted (-1, -1, 1, 1));
+    }
+}
+
+// private slot
+void kpThumbnailView::slotDocumentSizeChanged ()
+{
+    // Force a rebuild.
+    d->scaledImage = QImage ();
+    d->dirtyDocRegion = QRegion ();
+}
+
+
+// private
+void kpThumbnailView::updateScaledImage ()
+{
+    const kpDocument *doc = document ();
+    Q_ASSERT (doc);
+
+    const QSize scaledSize (zoomedDocWidth (), zoomedDocHeight ());
+    if (d->scaledImage.size () != scaledSize ||
+        d->scaledImageZoomX != zoomLevelX () ||
+        d->scaledImageZoomY != zoomLevelY ())
+    {
+    #if DEBUG_KP_THUMBNAIL_VIEW
+        qCDebug(kpLogViews) << "kpThumbnailView::updateScaledImage() rebuild size="
+                            << scaledSize;
+    #endif
+        d->scaledImage = QImage (scaledSize, QImage::Format_ARGB32_Premultiplied);
+        d->scaledImageZoomX = zoomLevelX ();
+        d->scaledImageZoomY = zoomLevelY ();
+        d->dirtyDocRegion = doc->rect ();
+    }
+
+    if (d->dirtyDocRegion.isEmpty ()) {
+        return;
+    }
+
+#if DEBUG_KP_THUMBNAIL_VIEW
+    qCDebug(kpLogViews) << "kpThumbnailView::updateScaledImage() dirty="
+                        << d->dirtyDocRegion;
+#endif
+
+    QPainter painter (&d->scaledImage);
+    painter.setCompositionMode (QPainter::CompositionMode_Source);
 
+    for (const QRect &dirtyDocRect : d->dirtyDocRegion)
+    {
+        // Grow by a pixel to cover rounding in the transformation.
+        const QRect scaledRect = transformDocToView (dirtyDocRect)
+            .translated (-origin ())
+            .adjusted (-1, -1, 1, 1)
+            .intersected (d->scaledImage.rect ());
+        if (scaledRect.isEmpty ()) {
+            continue;
+        }
+
+        // (this is the same scaling as in kpView::paintEventDrawDoc_Unclipped()
+        //  so the cache looks identical to a direct rendering)
+        const QRect docRect = paintEventGetDocRect (scaledRect.translated (origin ()));
+        if (docRect.isEmpty ()) {
+            continue;
+        }
+
+        painter.save ();
+        painter.setClipRect (scaledRect);
+        painter.scale (double (zoomLevelX ()) / 100.0,
+                       double (zoomLevelY ()) / 100.0);
+        painter.drawImage (docRect, doc->getImageViewAt (docRect));
+        painter.restore ();
+    }
+
+    d->dirtyDocRegion = QRegion ();
+}
+
+
+// protected virtual [base kpView]
+void kpThumbnailView::paintEventDrawDoc_Unclipped (const QRect &viewRect)
+{
+    kpViewManager *vm = viewManager ();
+    const kpDocument *doc = document ();
+
+    Q_ASSERT (vm);
+    Q_ASSERT (doc);
+
+    if (viewRect.isEmpty ()) {
+        return;
+    }
+
+    // Unzoomed, there is nothing to save by caching and the cache would
+    // just duplicate the document.
+    if (zoomLevelX () >= 100 && zoomLevelY () >= 100)
+    {
+        kpView::paintEventDrawDoc_Unclipped (viewRect);
+        return;
+    }
+
+    // The cache only holds the document so let the normal renderer
+    // composite anything that is on top of it.
+    const QRect docRect = paintEventGetDocRect (viewRect);
+    const kpTempImage *tempImage = vm->tempImage ();
+    if (doc->selection () ||
+        (tempImage && tempImage->isVisible (vm) && docRect.intersects (tempImage->rect ())))
+    {
+        kpView::paintEventDrawDoc_Unclipped (viewRect);
+        return;
+    }
+
+    updateScaledImage ();
+
+    const QRect scaledRect = viewRect.translated (-origin ())
+        .intersected (d->scaledImage.rect ());
+
+    QPainter painter (this);
+
+    if (doc->imagePointer ()->hasAlphaChannel ()) {
+        paintEventDrawCheckerBoard (&painter, viewRect);
+    }
+
+    if (!scaledRect.isEmpty ())
+    {
+        painter.drawImage (scaledRect.topLeft () + origin (),
+                           d->scaledImage, scaledRect);
+    }
+}
@@ -33,6 +33,8 @@
 #include "views/kpView.h"
 
 
+struct kpThumbnailViewPrivate;
+
 /**
  * @short Abstract base class for all thumbnail views.
  *
@@ -84,6 +86,32 @@ protected:
      * Extends @ref kpView.
      */
     void resizeEvent (QResizeEvent *e) override;
+
+
+    /**
+     * Draws the document from a cached, scaled copy of it, if the
+     * view is zoomed out and nothing is drawn on top of the document.
+     * Otherwise, the document is drawn like in any other view.
+     *
+     * Reimplements @ref kpView.
+     */
+    void paintEventDrawDoc_Unclipped (const QRect &viewRect) override;
+
+
+private slots:
+    void slotDocumentContentsChanged (const QRect &docRect);
+    void slotDocumentSizeChanged ();
+
+private:
+    /**
+     * Brings the cached, scaled copy of the document up to date, by
+     * rescaling only the document rectangles that changed since the last
+     * call.  The entire cache is rebuilt if the zoom level or document
+     * size changed.
+     */
+    void updateScaledImage ();
+
+    kpThumbnailViewPrivate * const d;
 };
 
 
@@ -79,6 +79,7 @@ kpView::kpView (kpDocument *document,
     d->vzoom = 100;
     d->origin = QPoint (0, 0);
     d->showGrid = false;
+    d->gridTileZoomX = d->gridTileZoomY = 0;
     d->isBuddyViewScrollableContainerRectangleShown = false;
 
     // Don't waste CPU drawing default background since its overridden by
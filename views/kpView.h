@@ -586,7 +586,10 @@ protected:
     // <painter>.
     void paintEventDrawGridLines (QPainter *painter, const QRect &viewRect);
 
-    void paintEventDrawDoc_Unclipped (const QRect &viewRect);
+    // Draws the part of the document (and any temp image or selection on
+    // top of it) corresponding to <viewRect>.  See the implementation for
+    // why this may draw outside <viewRect>.
+    virtual void paintEventDrawDoc_Unclipped (const QRect &viewRect);
     void paintEvent (QPaintEvent *e) override;
 
 
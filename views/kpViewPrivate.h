@@ -30,6 +30,7 @@
 #define kpViewPrivate_H
 
 
+#include <QImage>
 #include <QPoint>
 #include <QPointer>
 #include <QRect>
@@ -71,6 +72,11 @@ struct kpViewPrivate
     QRect buddyViewScrollableContainerRectangle;
 
     QRegion queuedUpdateArea;
+
+    // Pattern used by kpView::paintEventDrawGridLines(), valid for the
+    // zoom levels <gridTileZoomX> and <gridTileZoomY>.
+    QImage gridTile;
+    int gridTileZoomX, gridTileZoomY;
 };
 
 
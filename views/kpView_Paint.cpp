@@ -376,27 +376,44 @@ void kpView::paintEventDrawGridLines (QPainter *painter, const QRect &viewRect)
   int hzoomMultiple = zoomLevelX () / 100;
   int vzoomMultiple = zoomLevelY () / 100;
 
-  painter->setPen(Qt::gray);
+  // Instead of drawing a line per document pixel boundary, fill with a
+  // pattern of the grid.  A grid line passes through every view
+  // coordinate that is a multiple of the zoom multiple, so the pattern
+  // tiles from (0,0).
+  if (d->gridTile.isNull () ||
+      d->gridTileZoomX != zoomLevelX () || d->gridTileZoomY != zoomLevelY ())
+  {
+    // Make the tile a few cells big so that small zoom multiples don't
+    // result in tiny tiles.
+    const int tileWidth = hzoomMultiple * qMax (1, 64 / hzoomMultiple);
+    const int tileHeight = vzoomMultiple * qMax (1, 64 / vzoomMultiple);
+
+    d->gridTile = QImage (tileWidth, tileHeight, QImage::Format_ARGB32_Premultiplied);
+    d->gridTile.fill (Qt::transparent);
+
+    QPainter tilePainter (&d->gridTile);
+    tilePainter.setPen (Qt::gray);
+
+    // horizontal lines
+    for (int y = 0; y < tileHeight; y += vzoomMultiple) {
+      tilePainter.drawLine (0, y, tileWidth - 1, y);
+    }
 
-  // horizontal lines
-  int starty = viewRect.top();
-  if (starty % vzoomMultiple) {
-    starty = (starty + vzoomMultiple) / vzoomMultiple * vzoomMultiple;
-  }
+    // vertical lines
+    for (int x = 0; x < tileWidth; x += hzoomMultiple) {
+      tilePainter.drawLine (x, 0, x, tileHeight - 1);
+    }
 
-  for (int y = starty; y <= viewRect.bottom(); y += vzoomMultiple) {
-    painter->drawLine(viewRect.left(), y, viewRect.right(), y);
-  }
+    tilePainter.end ();
 
-  // vertical lines
-  int startx = viewRect.left();
-  if (startx % hzoomMultiple) {
-    startx = (startx + hzoomMultiple) / hzoomMultiple * hzoomMultiple;
+    d->gridTileZoomX = zoomLevelX ();
+    d->gridTileZoomY = zoomLevelY ();
   }
 
-  for (int x = startx; x <= viewRect.right(); x += hzoomMultiple) {
-    painter->drawLine(x, viewRect.top (), x, viewRect.bottom());
-  }
+  painter->save ();
+  painter->setBrushOrigin (0, 0);
+  painter->fillRect (viewRect, QBrush (d->gridTile));
+  painter->restore ();
 }
 
 //---------------------------------------------------------------------
@@ -463,13 +480,6 @@ void kpView::paintEventDrawDoc_Unclipped (const QRect &viewRect)
     // LOTODO: I think <docRect> being empty would be a bug.
     if (!docRect.isEmpty ())
     {
-        docPixmap = doc->getImageAt (docRect);
-
-    #if DEBUG_KP_VIEW_RENDERER && 1
-        qCDebug(kpLogViews) << "\tdocPixmap.hasAlphaChannel()="
-                  << docPixmap.hasAlphaChannel ();
-    #endif
-
         tempImageWillBeRendered =
             (!doc->selection () &&
              vm->tempImage () &&
@@ -485,6 +495,21 @@ void kpView::paintEventDrawDoc_Unclipped (const QRect &viewRect)
                    << ")"
                    << endl;
     #endif
+
+        // Only copy the document pixels if something will be composited
+        // on top of them.  Otherwise, blit straight from the document's
+        // memory.
+        if (doc->selection () || tempImageWillBeRendered) {
+            docPixmap = doc->getImageAt (docRect);
+        }
+        else {
+            docPixmap = doc->getImageViewAt (docRect);
+        }
+
+    #if DEBUG_KP_VIEW_RENDERER && 1
+        qCDebug(kpLogViews) << "\tdocPixmap.hasAlphaChannel()="
+                  << docPixmap.hasAlphaChannel ();
+    #endif
     }
 
 
@@ -606,9 +631,10 @@ void kpView::paintEvent (QPaintEvent *e)
 
     if ( isGridShown() )
     {
+      // Composite the grid over the whole region in one pass.
       QPainter painter(this);
-      for (const QRect &r : viewRegion)
-        paintEventDrawGridLines(&painter, r);
+      painter.setClipRegion(viewRegion);
+      paintEventDrawGridLines(&painter, viewRegion.boundingRect());
     }
 
     const QRect r = buddyViewScrollableContainerRectangle();
@@ -76,6 +76,18 @@ kpViewManager::kpViewManager (kpMainWindow *mainWindow)
 
     d->queueUpdatesCounter = d->fastUpdatesCounter = 0;
 
+    // d->pendingUpdateDocRegion
+    d->pendingUpdateIsFast = false;
+
+    d->updateFlushTimer = new QTimer (this);
+    d->updateFlushTimer->setSingleShot (true);
+    connect (d->updateFlushTimer, &QTimer::timeout,
+             this, &kpViewManager::flushViewUpdates);
+
+    // d->lastUpdateFlushTime
+
+    resetUpdateStatistics ();
+
     d->inputMethodEnabled = false;
 }
 
@@ -279,6 +291,32 @@ void kpViewManager::setTempImage (const kpTempImage &tempImage)
 
 //---------------------------------------------------------------------
 
+// public
+void kpViewManager::updateTempImage (const kpTempImage &tempImage,
+        const QRect &changedDocRect)
+{
+#if DEBUG_KP_VIEW_MANAGER
+    qCDebug(kpLogViews) << "kpViewManager::updateTempImage(topLeft="
+               << tempImage.topLeft ()
+               << ",changedDocRect=" << changedDocRect
+               << ")";
+#endif
+
+    if (!d->tempImage)
+    {
+        setTempImage (tempImage);
+        return;
+    }
+
+    *d->tempImage = tempImage;
+
+    if (changedDocRect.isValid ()) {
+        updateViews (changedDocRect);
+    }
+}
+
+//---------------------------------------------------------------------
+
 // public
 void kpViewManager::invalidateTempImage ()
 {
@@ -116,6 +116,10 @@ public:
 public:
     const kpTempImage *tempImage () const;
     void setTempImage (const kpTempImage &tempImage);
+    // Same as setTempImage() but only repaints <changedDocRect>, for when
+    // the caller knows that the new temp image only looks different from
+    // the current one there.
+    void updateTempImage (const kpTempImage &tempImage, const QRect &changedDocRect);
     void invalidateTempImage ();
 
 
@@ -237,8 +241,49 @@ public slots:
 
     void updateViewRectangleEdges (kpView *v, const QRect &viewRect);
 
+    // Marks <docRect> dirty in all views.
+    //
+    // Outside of setQueueUpdates() blocks, requests are not forwarded to
+    // the views straight away.  They are merged into a tile-aligned
+    // document region that is flushed at most once per display frame
+    // (immediately, if a frame has already passed since the last flush).
+    // If any of the merged requests was made with fastUpdates() enabled,
+    // the flush repaints instead of just scheduling paint events.
     void updateViews (const QRect &docRect);
 
+public:
+    // Returns the time between frames of the display, which updateViews()
+    // merges requests over.
+    static int frameIntervalMsec ();
+
+    // Profiling counters for updateViews().
+    struct UpdateStatistics
+    {
+        // Number of calls to updateViews().
+        qint64 requests;
+        // Number of requests that were merged into an already pending
+        // flush, instead of causing one of their own.
+        qint64 merged;
+        // Number of times the pending region was sent to the views.
+        qint64 flushes;
+        // Total area (in view pixels, summed over all views) handed to the
+        // views to repaint by updateView().  For a region, only its
+        // rectangles are counted, not the gaps between them.
+        qint64 paintedPixels;
+    };
+
+    UpdateStatistics updateStatistics () const;
+    void resetUpdateStatistics ();
+
+private:
+    // Sends <docRegion> to all views, honoring queueUpdates() and
+    // fastUpdates().
+    void updateViewsNow (const QRegion &docRegion);
+
+private slots:
+    // Sends the region accumulated by updateViews() to all views.
+    void flushViewUpdates ();
+
 
 public slots:
     void adjustViewsToEnvironment ();
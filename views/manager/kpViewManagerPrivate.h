@@ -31,7 +31,11 @@
 
 
 #include <QCursor>
+#include <QElapsedTimer>
 #include <QList>
+#include <QRegion>
+
+#include "views/manager/kpViewManager.h"
 
 
 class kpMainWindow;
@@ -74,6 +78,20 @@ struct kpViewManagerPrivate
 
     int queueUpdatesCounter, fastUpdatesCounter;
 
+    // Document region waiting to be sent to the views by
+    // kpViewManager::flushViewUpdates().  Always tile-aligned.
+    QRegion pendingUpdateDocRegion;
+    // Whether any request merged into <pendingUpdateDocRegion> was made
+    // while kpViewManager::fastUpdates() was enabled.
+    bool pendingUpdateIsFast;
+
+    // (single shot)
+    QTimer *updateFlushTimer;
+    // Started at each flush.  Invalid before the first one.
+    QElapsedTimer lastUpdateFlushTime;
+
+    kpViewManager::UpdateStatistics updateStatistics;
+
     //
     // Input Method
     //
@@ -34,6 +34,8 @@
 
 #include <QApplication>
 #include <QList>
+#include <QRegion>
+#include <QScreen>
 #include <QTimer>
 
 #include "kpLogCategories.h"
@@ -123,6 +125,8 @@ void kpViewManager::updateView (kpView *v, const QRect &viewRect)
 {
     if (!queueUpdates ())
     {
+        d->updateStatistics.paintedPixels += qint64 (viewRect.width ()) * viewRect.height ();
+
         if (fastUpdates ()) {
             v->repaint (viewRect);
         }
@@ -146,11 +150,17 @@ void kpViewManager::updateView (kpView *v, const QRegion &viewRegion)
 {
     if (!queueUpdates ())
     {
+        for (const QRect &viewRect : viewRegion) {
+            d->updateStatistics.paintedPixels += qint64 (viewRect.width ()) * viewRect.height ();
+        }
+
+        // (pass the region itself, not its bounding rectangle, so that the
+        //  gaps between disjoint rectangles are not repainted)
         if (fastUpdates ()) {
             v->repaint (viewRegion);
         }
         else {
-            v->update (viewRegion.boundingRect ());
+            v->update (viewRegion);
         }
     }
     else {
@@ -192,6 +202,45 @@ void kpViewManager::updateViewRectangleEdges (kpView *v, const QRect &viewRect)
     }
 }
 
+// Size (in document pixels) of the tiles that updateViews() rounds dirty
+// rectangles out to.  This keeps the pending region down to a handful of
+// rectangles during a stroke, at the cost of repainting a little more.
+static const int UpdateTileSize = 16;
+
+// Used if the screen does not report its refresh rate.
+static const int DefaultFrameIntervalMsec = 16;
+
+//--------------------------------------------------------------------------------
+
+static int FloorToTile (int x)
+{
+    return (x >= 0 ? x / UpdateTileSize : (x - UpdateTileSize + 1) / UpdateTileSize) *
+        UpdateTileSize;
+}
+
+static QRect TileAlignedRect (const QRect &docRect)
+{
+    const int left = ::FloorToTile (docRect.left ());
+    const int top = ::FloorToTile (docRect.top ());
+    const int right = ::FloorToTile (docRect.right ()) + UpdateTileSize - 1;
+    const int bottom = ::FloorToTile (docRect.bottom ()) + UpdateTileSize - 1;
+
+    return {QPoint (left, top), QPoint (right, bottom)};
+}
+
+// public static
+int kpViewManager::frameIntervalMsec ()
+{
+    const QScreen *screen = QGuiApplication::primaryScreen ();
+    if (!screen || screen->refreshRate () < 1) {
+        return DefaultFrameIntervalMsec;
+    }
+
+    return qMax (1, qRound (1000.0 / screen->refreshRate ()));
+}
+
+//--------------------------------------------------------------------------------
+
 // public slot
 void kpViewManager::updateViews (const QRect &docRect)
 {
@@ -199,36 +248,146 @@ void kpViewManager::updateViews (const QRect &docRect)
     qCDebug(kpLogViews) << "kpViewManager::updateViews (" << docRect << ")";
 #endif
 
+    if (!docRect.isValid ()) {
+        return;
+    }
+
+    d->updateStatistics.requests++;
+
+    // The views collect everything themselves until restoreQueueUpdates(),
+    // so there is nothing for us to merge.
+    if (queueUpdates ())
+    {
+        updateViewsNow (docRect);
+        return;
+    }
+
+    if (!d->pendingUpdateDocRegion.isEmpty ()) {
+        d->updateStatistics.merged++;
+    }
+
+    d->pendingUpdateDocRegion += ::TileAlignedRect (docRect);
+    if (fastUpdates ()) {
+        d->pendingUpdateIsFast = true;
+    }
+
+    const int frameInterval = frameIntervalMsec ();
+    const qint64 sinceLastFlush = d->lastUpdateFlushTime.isValid () ?
+        d->lastUpdateFlushTime.elapsed () : frameInterval;
+
+    if (sinceLastFlush >= frameInterval)
+    {
+        // Idle for at least a frame: don't add any latency.
+        if (fastUpdates ())
+        {
+            flushViewUpdates ();
+            return;
+        }
+
+        if (!d->updateFlushTimer->isActive ()) {
+            d->updateFlushTimer->start (0);
+        }
+    }
+    else if (!d->updateFlushTimer->isActive ())
+    {
+        d->updateFlushTimer->start (int (frameInterval - sinceLastFlush));
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+// private
+void kpViewManager::updateViewsNow (const QRegion &docRegion)
+{
     foreach (kpView *view, d->views)
     {
     #if DEBUG_KP_VIEW_MANAGER && 0
         qCDebug(kpLogViews) << "\tupdating view " << view->name ();
     #endif
-        if (view->zoomLevelX () % 100 == 0 && view->zoomLevelY () % 100 == 0)
-        {
-        #if DEBUG_KP_VIEW_MANAGER && 0
-            qCDebug(kpLogViews) << "\t\tviewRect=" << view->transformDocToView (docRect);
-        #endif
-            updateView (view, view->transformDocToView (docRect));
-        }
-        else
+        QRegion viewRegion;
+
+        for (const QRect &docRect : docRegion)
         {
-            QRect viewRect = view->transformDocToView (docRect);
+            if (view->zoomLevelX () % 100 == 0 && view->zoomLevelY () % 100 == 0)
+            {
+                viewRegion += view->transformDocToView (docRect);
+            }
+            else
+            {
+                QRect viewRect = view->transformDocToView (docRect);
 
-            int diff = qRound (double (qMax (view->zoomLevelX (), view->zoomLevelY ())) / 100.0) + 1;
+                int diff = qRound (double (qMax (view->zoomLevelX (), view->zoomLevelY ())) / 100.0) + 1;
 
-            QRect newRect = QRect (viewRect.x () - diff,
-                                   viewRect.y () - diff,
-                                   viewRect.width () + 2 * diff,
-                                   viewRect.height () + 2 * diff)
-                                .intersected (QRect (0, 0, view->width (), view->height ()));
+                viewRegion += QRect (viewRect.x () - diff,
+                                     viewRect.y () - diff,
+                                     viewRect.width () + 2 * diff,
+                                     viewRect.height () + 2 * diff)
+                                  .intersected (QRect (0, 0, view->width (), view->height ()));
+            }
+        }
 
-        #if DEBUG_KP_VIEW_MANAGER && 0
-            qCDebug(kpLogViews) << "\t\tviewRect (+compensate)=" << newRect;
-        #endif
-            updateView (view, newRect);
+    #if DEBUG_KP_VIEW_MANAGER && 0
+        qCDebug(kpLogViews) << "\t\tviewRegion=" << viewRegion;
+    #endif
+        if (viewRegion.isEmpty ()) {
+            continue;
         }
+
+        updateView (view, viewRegion);
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+// private slot
+void kpViewManager::flushViewUpdates ()
+{
+    d->updateFlushTimer->stop ();
+
+    if (d->pendingUpdateDocRegion.isEmpty ()) {
+        return;
     }
+
+    const QRegion docRegion = d->pendingUpdateDocRegion;
+    const bool isFast = d->pendingUpdateIsFast;
+
+    d->pendingUpdateDocRegion = QRegion ();
+    d->pendingUpdateIsFast = false;
+
+    d->lastUpdateFlushTime.start ();
+    d->updateStatistics.flushes++;
+
+#if DEBUG_KP_VIEW_MANAGER && 0
+    qCDebug(kpLogViews) << "kpViewManager::flushViewUpdates() docRegion=" << docRegion
+                        << " isFast=" << isFast;
+#endif
+
+    if (isFast) {
+        setFastUpdates ();
+    }
+
+    updateViewsNow (docRegion);
+
+    if (isFast) {
+        restoreFastUpdates ();
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+// public
+kpViewManager::UpdateStatistics kpViewManager::updateStatistics () const
+{
+    return d->updateStatistics;
+}
+
+// public
+void kpViewManager::resetUpdateStatistics ()
+{
+    d->updateStatistics.requests = 0;
+    d->updateStatistics.merged = 0;
+    d->updateStatistics.flushes = 0;
+    d->updateStatistics.paintedPixels = 0;
 }
 
 //--------------------------------------------------------------------------------
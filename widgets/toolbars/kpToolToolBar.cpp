@@ -43,6 +43,7 @@
 #include "tools/kpTool.h"
 #include "tools/kpToolAction.h"
 #include "widgets/toolbars/options/kpToolWidgetBrush.h"
+#include "widgets/toolbars/options/kpToolWidgetColorPickerSize.h"
 #include "widgets/toolbars/options/kpToolWidgetEraserSize.h"
 #include "widgets/toolbars/options/kpToolWidgetFillStyle.h"
 #include "widgets/toolbars/options/kpToolWidgetLineWidth.h"
@@ -88,6 +89,8 @@ kpToolToolBar::kpToolToolBar(const QString &name, int colsOrRows, QMainWindow *p
 
     m_toolWidgets.append (m_toolWidgetBrush =
         new kpToolWidgetBrush (m_baseWidget, QStringLiteral("Tool Widget Brush")));
+    m_toolWidgets.append (m_toolWidgetColorPickerSize =
+        new kpToolWidgetColorPickerSize (m_baseWidget, QStringLiteral("Tool Widget Color Picker Size")));
     m_toolWidgets.append (m_toolWidgetEraserSize =
         new kpToolWidgetEraserSize (m_baseWidget, QStringLiteral("Tool Widget Eraser Size")));
     m_toolWidgets.append (m_toolWidgetFillStyle =
@@ -47,6 +47,7 @@ class kpToolButton;
 
 class kpToolWidgetBase;
 class kpToolWidgetBrush;
+class kpToolWidgetColorPickerSize;
 class kpToolWidgetEraserSize;
 class kpToolWidgetFillStyle;
 class kpToolWidgetLineWidth;
@@ -73,6 +74,7 @@ public:
     void hideAllToolWidgets ();
     // could this be cleaner (the tools have to access them individually somehow)?
     kpToolWidgetBrush *toolWidgetBrush () const { return m_toolWidgetBrush; }
+    kpToolWidgetColorPickerSize *toolWidgetColorPickerSize () const { return m_toolWidgetColorPickerSize; }
     kpToolWidgetEraserSize *toolWidgetEraserSize () const { return m_toolWidgetEraserSize; }
     kpToolWidgetFillStyle *toolWidgetFillStyle () const { return m_toolWidgetFillStyle; }
     kpToolWidgetLineWidth *toolWidgetLineWidth () const { return m_toolWidgetLineWidth; }
@@ -106,6 +108,7 @@ private:
     QGridLayout *m_toolLayout;
 
     kpToolWidgetBrush *m_toolWidgetBrush;
+    kpToolWidgetColorPickerSize *m_toolWidgetColorPickerSize;
     kpToolWidgetEraserSize *m_toolWidgetEraserSize;
     kpToolWidgetFillStyle *m_toolWidgetFillStyle;
     kpToolWidgetLineWidth *m_toolWidgetLineWidth;
@@ -0,0 +1,115 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+
+#define DEBUG_KP_TOOL_WIDGET_COLOR_PICKER_SIZE 0
+
+
+#include "kpToolWidgetColorPickerSize.h"
+
+#include "imagelib/kpColor.h"
+#include "imagelib/kpPainter.h"
+
+#include "kpLogCategories.h"
+#include <KLocalizedString>
+
+#include <QImage>
+#include <QPixmap>
+
+
+static int ColorPickerSizes [] = {1, 3, 5, 9, 17};
+static const int NumColorPickerSizes =
+    int (sizeof (::ColorPickerSizes) / sizeof (::ColorPickerSizes [0]));
+
+//---------------------------------------------------------------------
+
+kpToolWidgetColorPickerSize::kpToolWidgetColorPickerSize (QWidget *parent,
+        const QString &name)
+    : kpToolWidgetBase (parent, name)
+{
+    for (int i = 0; i < ::NumColorPickerSizes; i++)
+    {
+        if (i == 3) {
+            startNewOptionRow ();
+        }
+
+        const int s = ::ColorPickerSizes [i];
+
+        QImage previewImage (s, s, QImage::Format_ARGB32_Premultiplied);
+        if (i < 3)
+        {
+            // HACK: kpToolWidgetBase's layout code sucks and gives uneven spacing
+            previewImage = QImage ((width () - 4) / 3, 9, QImage::Format_ARGB32_Premultiplied);
+            Q_ASSERT (previewImage.width () >= s &&
+                previewImage.height () >= s);
+        }
+
+        previewImage.fill (0);
+
+        kpPainter::fillRect (&previewImage,
+            (previewImage.width () - s) / 2, (previewImage.height () - s) / 2,
+            s, s,
+            kpColor::Black);
+
+        addOption (QPixmap::fromImage (previewImage), i18n ("%1x%2", s, s)/*tooltip*/);
+    }
+
+    finishConstruction (0, 0);
+}
+
+//---------------------------------------------------------------------
+
+kpToolWidgetColorPickerSize::~kpToolWidgetColorPickerSize () = default;
+
+//---------------------------------------------------------------------
+
+// public
+int kpToolWidgetColorPickerSize::colorPickerSize () const
+{
+    return ::ColorPickerSizes [selected () < 0 ? 0 : selected ()];
+}
+
+//---------------------------------------------------------------------
+
+// protected slot virtual [base kpToolWidgetBase]
+bool kpToolWidgetColorPickerSize::setSelected (int row, int col, bool saveAsDefault)
+{
+    const bool ret = kpToolWidgetBase::setSelected (row, col, saveAsDefault);
+    if (ret)
+    {
+    #if DEBUG_KP_TOOL_WIDGET_COLOR_PICKER_SIZE
+        qCDebug(kpLogWidgets) << "kpToolWidgetColorPickerSize::setSelected() size="
+                              << colorPickerSize ();
+    #endif
+        emit colorPickerSizeChanged (colorPickerSize ());
+    }
+    return ret;
+}
+
+//---------------------------------------------------------------------
@@ -0,0 +1,58 @@
+
+/*
+   Copyright (c) 2026 The KolourPaint Authors
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+   IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+   OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+   IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+   INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+   NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+
+#ifndef KP_TOOL_WIDGET_COLOR_PICKER_SIZE_H
+#define KP_TOOL_WIDGET_COLOR_PICKER_SIZE_H
+
+
+#include "kpToolWidgetBase.h"
+
+
+// Lets the user choose the size of the square that the color picker
+// averages, centered on the cursor (1x1 picks just the pixel).
+class kpToolWidgetColorPickerSize : public kpToolWidgetBase
+{
+Q_OBJECT
+
+public:
+    kpToolWidgetColorPickerSize (QWidget *parent, const QString &name);
+    ~kpToolWidgetColorPickerSize () override;
+
+    int colorPickerSize () const;
+
+signals:
+    void colorPickerSizeChanged (int size);
+
+protected slots:
+    bool setSelected (int row, int col, bool saveAsDefault) override;
+};
+
+
+#endif  // KP_TOOL_WIDGET_COLOR_PICKER_SIZE_H